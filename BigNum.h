@@ -1,13 +1,28 @@
 #pragma once
 // here you can include whatever you want :)
 #include <string>
+#include <string_view>
+#include <charconv>
 #include <cstdint>
 #include <vector>
 #include <cctype>
 #include <functional>
 #include <iostream>
+#include <locale>
 #include <sstream>
 #include <cmath>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <iterator>
+#include <initializer_list>
+#include <bit>
+#include <utility>
+#include <deque>
+#include <cstring>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
 
 // if you do not plan to implement bonus, you can delete those lines
 // or just keep them as is and do not define the macro to 1
@@ -19,14 +34,22 @@ class BigInteger;
 
 inline BigInteger operator+(BigInteger lhs, const BigInteger& rhs);
 
+inline BigInteger operator+(const BigInteger& lhs, BigInteger&& rhs);
+
 inline BigInteger operator-(BigInteger lhs, const BigInteger& rhs);
 
+inline BigInteger operator-(const BigInteger& lhs, BigInteger&& rhs);
+
 inline BigInteger operator*(BigInteger lhs, const BigInteger& rhs);
 
+inline BigInteger operator*(const BigInteger& lhs, BigInteger&& rhs);
+
 inline BigInteger operator/(BigInteger lhs, const BigInteger& rhs);
 
 inline BigInteger operator%(BigInteger lhs, const BigInteger& rhs);
 
+inline std::pair<BigInteger, BigInteger> divmod(const BigInteger& lhs, const BigInteger& rhs);
+
 inline bool operator==(const BigInteger& lhs, const BigInteger& rhs);
 
 inline bool operator!=(const BigInteger& lhs, const BigInteger& rhs);
@@ -39,79 +62,320 @@ inline bool operator<=(const BigInteger& lhs, const BigInteger& rhs);
 
 inline bool operator>=(const BigInteger& lhs, const BigInteger& rhs);
 
-static double toDouble(const std::vector<int>& num);
+inline std::from_chars_result from_chars(const char* first, const char* last, BigInteger& value, int base = 10);
 
-class BigInteger {
+inline std::to_chars_result to_chars(char* first, char* last, const BigInteger& value, int base = 10);
+
+// magnitudes are stored as little-endian 64-bit limbs, zero is the empty vector
+// 10^19 is the largest power of ten that fits into one limb
+const uint64_t DECIMAL_CHUNK_BASE = 10000000000000000000ULL;
+const size_t DECIMAL_CHUNK_DIGITS = 19;
+
+// 64x64 -> 128 bit product, returns low half
+inline uint64_t mulWide(uint64_t a, uint64_t b, uint64_t& hi) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    return _umul128(a, b, &hi);
+#else
+    unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+    hi = static_cast<uint64_t>(product >> 64);
+    return static_cast<uint64_t>(product);
+#endif
+}
+
+// (hi:lo) / d for hi < d, returns quotient
+inline uint64_t divWide(uint64_t hi, uint64_t lo, uint64_t d, uint64_t& rem) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    return _udiv128(hi, lo, d, &rem);
+#else
+    unsigned __int128 n = (static_cast<unsigned __int128>(hi) << 64) | lo;
+    rem = static_cast<uint64_t>(n % d);
+    return static_cast<uint64_t>(n / d);
+#endif
+}
+
+// runs whenever a LimbVector moves to a heap buffer, the tests define it
+// to count allocations on the paths that should stay inline
+#ifndef LIMB_ALLOCATION_HOOK
+#define LIMB_ALLOCATION_HOOK()
+#endif
+
+// little-endian limb storage with a small inline buffer: values up to
+// INLINE_LIMBS limbs (128 bits) live inside the object, larger values spill to the heap
+class LimbVector {
 public:
-    // constructors
-    BigInteger() {
-        number = { 0 };
+    static const size_t INLINE_LIMBS = 2;
+
+    LimbVector() {
     }
 
-    BigInteger(int64_t n) {
+    explicit LimbVector(size_t count, uint64_t value = 0) {
+        resize(count, value);
+    }
 
-        if (n == std::numeric_limits<int64_t>::min()) {
-            sign = -1;
+    LimbVector(std::initializer_list<uint64_t> limbs) : LimbVector(limbs.begin(), limbs.end()) {
+    }
 
-            uint64_t positive_n = static_cast<uint64_t>(-(n + 1)) + 1;
-            while (positive_n != 0) {
-                int digit = static_cast<int>(positive_n % 10);
-                number.push_back(digit);
-                positive_n /= 10;
-            }
+    template <typename It, typename = typename std::iterator_traits<It>::iterator_category>
+    LimbVector(It first, It last) {
+        reserve(static_cast<size_t>(std::distance(first, last)));
+        for (; first != last; ++first) storage[length++] = *first;
+    }
+
+    LimbVector(const LimbVector& other) {
+        reserve(other.length);
+        std::copy(other.storage, other.storage + other.length, storage);
+        length = other.length;
+    }
+
+    LimbVector(LimbVector&& other) noexcept {
+        takeFrom(other);
+    }
+
+    LimbVector& operator=(const LimbVector& rhs) {
+        if (this != &rhs) {
+            // keep our own buffer whenever it is large enough
+            length = 0;
+            reserve(rhs.length);
+            std::copy(rhs.storage, rhs.storage + rhs.length, storage);
+            length = rhs.length;
         }
-        else {
-            sign = (n < 0) ? -1 : 1;
-            n = std::abs(n);
-            if (n == 0) number.push_back(0);
-            while (n != 0) {
-                int digit = static_cast<int>(n % 10);
-                number.push_back(digit);
-                n /= 10;
-            }
+        return *this;
+    }
+
+    LimbVector& operator=(LimbVector&& rhs) noexcept {
+        if (this != &rhs) {
+            release();
+            takeFrom(rhs);
         }
-        std::reverse(number.begin(), number.end());
+        return *this;
     }
 
-    explicit BigInteger(const std::string& str) {
-        std::string s = str;
-        if (s.empty()) throw std::invalid_argument("empty string");
-        //only sign
-        if (s.size() == 1 && !std::isdigit(s[0])) throw std::invalid_argument("received bad formatted string - only sign");
-        if (s[0] == '+') {
-            sign = 1;
-            s.erase(0, 1);
+    ~LimbVector() {
+        release();
+    }
+
+    size_t size() const { return length; }
+    bool empty() const { return length == 0; }
+    size_t capacity() const { return allocated; }
+
+    uint64_t* data() { return storage; }
+    const uint64_t* data() const { return storage; }
+    uint64_t* begin() { return storage; }
+    const uint64_t* begin() const { return storage; }
+    uint64_t* end() { return storage + length; }
+    const uint64_t* end() const { return storage + length; }
+
+    uint64_t& operator[](size_t i) { return storage[i]; }
+    const uint64_t& operator[](size_t i) const { return storage[i]; }
+    uint64_t& back() { return storage[length - 1]; }
+    const uint64_t& back() const { return storage[length - 1]; }
+
+    void reserve(size_t count) {
+        if (count <= allocated) return;
+        size_t grown = std::max(count, allocated * 2);
+        LIMB_ALLOCATION_HOOK();
+        uint64_t* buffer = new uint64_t[grown];
+        std::copy(storage, storage + length, buffer);
+        release();
+        storage = buffer;
+        allocated = grown;
+    }
+
+    void resize(size_t count, uint64_t value = 0) {
+        reserve(count);
+        if (count > length) std::fill(storage + length, storage + count, value);
+        length = count;
+    }
+
+    void assign(size_t count, uint64_t value) {
+        length = 0;
+        resize(count, value);
+    }
+
+    void push_back(uint64_t limb) {
+        if (length == allocated) reserve(length + 1);
+        storage[length++] = limb;
+    }
+
+    void pop_back() {
+        --length;
+    }
+
+    void clear() {
+        length = 0;
+    }
+
+    friend bool operator==(const LimbVector& lhs, const LimbVector& rhs) {
+        return lhs.length == rhs.length && std::equal(lhs.storage, lhs.storage + lhs.length, rhs.storage);
+    }
+
+    friend bool operator!=(const LimbVector& lhs, const LimbVector& rhs) {
+        return !(lhs == rhs);
+    }
+
+private:
+    void release() {
+        if (storage != local) delete[] storage;
+        storage = local;
+        allocated = INLINE_LIMBS;
+    }
+
+    // steals the heap buffer of other, inline limbs are copied
+    void takeFrom(LimbVector& other) {
+        if (other.storage == other.local) {
+            std::copy(other.local, other.local + other.length, local);
+        }
+        else {
+            storage = other.storage;
+            allocated = other.allocated;
+            other.storage = other.local;
+            other.allocated = INLINE_LIMBS;
         }
-        else if (s[0] == '-') {
+        length = other.length;
+        other.length = 0;
+    }
+
+    uint64_t local[INLINE_LIMBS] = {};
+    uint64_t* storage = local;
+    size_t length = 0;
+    size_t allocated = INLINE_LIMBS;
+};
+
+// multiplication kernel cut-offs, in limbs of the shorter operand
+#ifndef BIGNUM_KARATSUBA_THRESHOLD
+#define BIGNUM_KARATSUBA_THRESHOLD 32
+#endif
+#ifndef BIGNUM_TOOM3_THRESHOLD
+#define BIGNUM_TOOM3_THRESHOLD 200
+#endif
+#ifndef BIGNUM_NTT_THRESHOLD
+#define BIGNUM_NTT_THRESHOLD 1000
+#endif
+// division cut-offs, in limbs of the divisor
+#ifndef BIGNUM_BZ_THRESHOLD
+#define BIGNUM_BZ_THRESHOLD 80
+#endif
+#ifndef BIGNUM_NEWTON_THRESHOLD
+#define BIGNUM_NEWTON_THRESHOLD 1000
+#endif
+// squaring does half the schoolbook work, so the cut-offs sit higher
+#ifndef BIGNUM_KARATSUBA_SQR_THRESHOLD
+#define BIGNUM_KARATSUBA_SQR_THRESHOLD 96
+#endif
+#ifndef BIGNUM_TOOM3_SQR_THRESHOLD
+#define BIGNUM_TOOM3_SQR_THRESHOLD 300
+#endif
+// gcd operands from this many limbs on are reduced by the half gcd
+#ifndef BIGNUM_HGCD_THRESHOLD
+#define BIGNUM_HGCD_THRESHOLD 500
+#endif
+// BigRationalAccumulator reduces its sum once the denominator is this long
+#ifndef BIGNUM_ACCUMULATOR_LIMBS
+#define BIGNUM_ACCUMULATOR_LIMBS 32
+#endif
+// decimal conversion splits values from this many limbs on by powers of ten
+#ifndef BIGNUM_DECIMAL_THRESHOLD
+#define BIGNUM_DECIMAL_THRESHOLD 40
+#endif
+
+void trimLimbs(LimbVector& num);
+
+int compareMagnitude(const LimbVector& lhs, const LimbVector& rhs);
+
+size_t bitLength(const LimbVector& num);
+
+void mulAddSmall(LimbVector& num, uint64_t mul, uint64_t add);
+
+uint64_t divSmall(LimbVector& num, uint64_t divisor);
+
+void addInPlace(LimbVector& lhs, const LimbVector& rhs);
+
+void subtractInPlace(LimbVector& lhs, const LimbVector& rhs);
+
+void mulInPlace(LimbVector& lhs, const LimbVector& rhs);
+
+LimbVector multiply(const LimbVector& x, const LimbVector& y);
+
+LimbVector square(const LimbVector& x);
+
+const char* skipDecimalDigits(const char* first, const char* last);
+
+LimbVector parseDecimal(const char* first, const char* last);
+
+inline int radixDigitValue(char c);
+
+inline size_t radixChunkDigits(int base, uint64_t& power);
+
+size_t radixBufferSize(const LimbVector& num, int base);
+
+char* writeRadix(const LimbVector& num, char* out, int base);
+
+const char* skipRadixDigits(const char* first, const char* last, int base);
+
+LimbVector parseRadix(const char* first, const char* last, int base);
+
+LimbVector joinRadixChunks(const uint64_t* words, size_t count, int base, size_t chunkDigits, uint64_t power);
+
+static double toDouble(const LimbVector& num);
+
+class BigInteger {
+public:
+    // constructors
+    BigInteger() {
+    }
+
+    BigInteger(int64_t n) {
+        if (n < 0) {
             sign = -1;
-            s.erase(0, 1);
+            // negate in unsigned arithmetic so that int64 min does not overflow
+            number.push_back(~static_cast<uint64_t>(n) + 1);
+        }
+        else if (n > 0) {
+            number.push_back(static_cast<uint64_t>(n));
         }
-        else if (!std::isdigit(s[0])) throw std::invalid_argument("received bad formatted string");
+    }
 
-        //remove leading zeroes but preserve last one
-        while (s[0] == '0') s.erase(0, 1);
-        if (s.empty()) {
-            number = { 0 };
-            sign = 1;
+    explicit BigInteger(std::string_view str, int base = 10) {
+        if (base < 2 || base > 36) throw std::invalid_argument("invalid argument - base must be between 2 and 36.");
+        if (str.empty()) throw std::invalid_argument("empty string");
+        const char* first = str.data();
+        const char* last = first + str.size();
+        const bool negative = *first == '-';
+        if (*first == '+' || *first == '-') {
+            //only sign
+            if (str.size() == 1) throw std::invalid_argument("received bad formatted string - only sign");
+            ++first;
         }
-        else {
-            for (size_t i = 0; i < s.size(); ++i) {
-                if (!isdigit(s[i])) {
-                    throw std::invalid_argument("Invalid string for BigInteger - not a digit");
-                }
-                number.push_back(s[i] - '0');
-            }
+        else if (radixDigitValue(*first) >= base) throw std::invalid_argument("received bad formatted string");
+
+        if (skipRadixDigits(first, last, base) != last) {
+            throw std::invalid_argument("Invalid string for BigInteger - not a digit");
         }
+        //skip leading zeroes, nothing left means zero
+        while (first != last && *first == '0') ++first;
+        number = parseRadix(first, last, base);
+        if (negative && !number.empty()) sign = -1;
     }
 
     // copy
-    BigInteger(const BigInteger& other) {
-        number = other.number;
-        sign = other.sign;
-    }
+    BigInteger(const BigInteger& other) = default;
 
     BigInteger& operator=(const BigInteger& rhs) = default;
 
+    // move, the source is left as zero
+    BigInteger(BigInteger&& other) noexcept : number(std::move(other.number)), sign(other.sign) {
+        other.sign = 1;
+    }
+
+    BigInteger& operator=(BigInteger&& rhs) noexcept {
+        if (this != &rhs) {
+            number = std::move(rhs.number);
+            sign = rhs.sign;
+            rhs.sign = 1;
+        }
+        return *this;
+    }
+
     // unary operators
     const BigInteger& operator+() const {
         return *this;
@@ -119,40 +383,75 @@ public:
 
     BigInteger operator-() const {
         BigInteger result = *this;
-        result.sign = -this->sign;
+        if (!number.empty()) result.sign = -this->sign;
         return result;
     }
 
     // binary arithmetics operators
+    // +=, -= and *= work in the limb buffer of *this and reuse its capacity
     BigInteger& operator+=(const BigInteger& rhs) {
-        const BigInteger temp = *this + rhs;
-        *this = temp;
+        if (sign == rhs.sign) {
+            addInPlace(number, rhs.number);
+        }
+        else {
+            // the result takes the sign of the operand with the larger magnitude
+            if (compareMagnitude(number, rhs.number) < 0) sign = rhs.sign;
+            subtractInPlace(number, rhs.number);
+            if (number.empty()) sign = 1;
+        }
         return *this;
     }
 
     BigInteger& operator-=(const BigInteger& rhs) {
-        const BigInteger temp = *this - rhs;
-        *this = temp;
+        if (sign != rhs.sign) {
+            addInPlace(number, rhs.number);
+        }
+        else {
+            if (compareMagnitude(number, rhs.number) < 0) sign = -sign;
+            subtractInPlace(number, rhs.number);
+            if (number.empty()) sign = 1;
+        }
         return *this;
     }
 
     BigInteger& operator*=(const BigInteger& rhs) {
-        const BigInteger temp = *this * rhs;
-        *this = temp;
+        if (number.empty() || rhs.number.empty()) {
+            number.clear();
+            sign = 1;
+            return *this;
+        }
+        sign *= rhs.sign;
+        if (number == rhs.number) {
+            // x * x, also when rhs is *this or a copy of it
+            number = ::square(number);
+        }
+        else if (std::min(number.size(), rhs.number.size()) < BIGNUM_KARATSUBA_THRESHOLD) {
+            mulInPlace(number, rhs.number);
+        }
+        else {
+            number = multiply(number, rhs.number);
+        }
         return *this;
     }
 
     BigInteger& operator/=(const BigInteger& rhs) {
-        *this = *this / rhs;
+        *this = std::move(divmod(*this, rhs).first);
         return *this;
     }
 
     BigInteger& operator%=(const BigInteger& rhs) {
-        *this = *this % rhs;
+        *this = std::move(divmod(*this, rhs).second);
         return *this;
     }
 
 
+    // *this * *this, computing every cross product only once
+    BigInteger square() const {
+        BigInteger result;
+        result.number = ::square(number);
+        return result;
+    }
+
     double sqrt() const {
         if (sign == -1) {
             throw std::runtime_error("invalid argument - negative number.");
@@ -163,10 +462,14 @@ public:
         return std::sqrt(numAsDouble);
     }
 
-    std::string toString() {
-        std::ostringstream stream;
-        stream << *this;
-        return stream.str();
+    // digits 0-9 and a-z for bases 2 to 36
+    std::string toString(int base = 10) const {
+        if (base < 2 || base > 36) throw std::invalid_argument("invalid argument - base must be between 2 and 36.");
+        const bool negative = sign == -1 && !number.empty();
+        std::string result(radixBufferSize(number, base) + (negative ? 1 : 0), '-');
+        char* digits = result.data() + (negative ? 1 : 0);
+        result.resize(static_cast<size_t>(writeRadix(number, digits, base) - result.data()));
+        return result;
     }
 
 #if SUPPORT_ISQRT == 1
@@ -178,7 +481,7 @@ public:
         BigInteger left(0), right(*this), result;
         while (left <= right) {
             BigInteger mid = (left + right) / 2;
-            BigInteger midSquared = mid * mid;
+            BigInteger midSquared = mid.square();
 
             if (midSquared <= *this) {
                 result = mid;
@@ -194,7 +497,7 @@ public:
 private:
     // here you can add private data and members, but do not add stuff to
     // public interface, also you can declare friends here if you want
-    std::vector<int> number;
+    LimbVector number;
     int sign = 1;
 
     friend std::ostream& operator<<(std::ostream& os, const BigInteger& bigInt);
@@ -203,32 +506,62 @@ private:
 
     friend void setSign(BigInteger& bigInt, int sign);
 
-    friend const std::vector<int>& getNumber(const BigInteger& bigInt);
+    friend const LimbVector& getNumber(const BigInteger& bigInt);
 
-    friend void setNumber(BigInteger& bigInt, const std::vector<int>& num);
+    friend void setNumber(BigInteger& bigInt, const LimbVector& num);
 
     friend BigInteger abs(const BigInteger& bigInt);
 
-    friend std::vector<int> add(const std::vector<int>& lhs, const std::vector<int>& rhs);
+    friend LimbVector add(const LimbVector& lhs, const LimbVector& rhs);
 
-    friend std::vector<int> subtract(const std::vector<int>& lhs, const std::vector<int>& rhs);
+    friend LimbVector subtract(const LimbVector& lhs, const LimbVector& rhs);
 
-    friend inline BigInteger operator/(BigInteger lhs, const BigInteger& rhs);
+    friend inline std::pair<BigInteger, BigInteger> divmod(const BigInteger& lhs, const BigInteger& rhs);
+
+    friend inline std::from_chars_result from_chars(const char* first, const char* last, BigInteger& value, int base);
+
+    friend inline bool readNumber(std::istream& in, BigInteger& value, int stop, int base);
+
+    friend inline std::to_chars_result to_chars(char* first, char* last, const BigInteger& value, int base);
+
+    friend inline std::istream& readBinaryValue(std::istream& in, BigInteger& value);
+
+    friend class BigIntegerView;
+    friend class BigModulus;
 };
 
-std::vector<int> add(const std::vector<int>& lhs, const std::vector<int>& rhs);
+LimbVector add(const LimbVector& lhs, const LimbVector& rhs);
+
+LimbVector subtract(const LimbVector& lhs, const LimbVector& rhs);
+
+LimbVector karatsuba_mul(const LimbVector& x, const LimbVector& y);
+
+LimbVector toom3_mul(const LimbVector& x, const LimbVector& y);
 
-std::vector<int> subtract(const std::vector<int>& lhs, const std::vector<int>& rhs);
+LimbVector ntt_mul(const LimbVector& x, const LimbVector& y);
 
-//std::vector<int> karatsubaMultiplication(const std::vector<int>& x, const std::vector<int>& y);
-std::vector<int> karatsuba_mul(const std::vector<int>& x, const std::vector<int>& y);
+LimbVector naive_mul(const LimbVector& x, const LimbVector& y);
 
-std::vector<int> naive_mul(const std::vector<int>& x, const std::vector<int>& y);
+LimbVector naive_sqr(const LimbVector& x);
 
-static double toDouble(const std::vector<int>& num) {
+LimbVector karatsuba_sqr(const LimbVector& x);
+
+void divideMagnitude(const LimbVector& lhs, const LimbVector& rhs,
+    LimbVector& quotient, LimbVector& remainder);
+
+void divideKnuth(const LimbVector& lhs, const LimbVector& rhs,
+    LimbVector& quotient, LimbVector& remainder);
+
+void divideTwoByOne(const LimbVector& a, const LimbVector& b, LimbVector& quotient, LimbVector& remainder);
+
+LimbVector reciprocal(const LimbVector& b);
+
+LimbVector gcdMagnitude(LimbVector a, LimbVector b);
+
+static double toDouble(const LimbVector& num) {
     double numAsDouble = 0;
-    for (size_t i = 0; i < num.size(); ++i) {
-        numAsDouble += num[i] * std::pow(10, num.size() - i - 1);
+    for (size_t i = num.size(); i-- > 0;) {
+        numAsDouble = numAsDouble * 18446744073709551616.0 + static_cast<double>(num[i]);
     }
 
     // Check for overflow
@@ -243,99 +576,61 @@ static double toDouble(const BigInteger& bi) {
 }
 
 
+// the by-value lhs recycles the storage of a temporary left operand,
+// the rvalue overloads do the same for a temporary right operand
 inline BigInteger operator+(BigInteger lhs, const BigInteger& rhs) {
-    BigInteger addition = BigInteger();
-    if (getSign(lhs) == getSign(rhs)) {
-        setNumber(addition, add(getNumber(lhs), getNumber(rhs)));
-        setSign(addition, getSign(lhs));
-    }
-    else {
-        if (abs(lhs) == abs(rhs)) return BigInteger(0);
-
-        if (abs(lhs) > abs(rhs)) {
-            setNumber(addition, subtract(getNumber(lhs), getNumber(rhs)));
-            setSign(addition, getSign(lhs));
-        }
-        else {
-            setNumber(addition, subtract(getNumber(rhs), getNumber(lhs)));
-            setSign(addition, getSign(rhs));
-        }
-    }
+    lhs += rhs;
+    return lhs;
+}
 
-    return addition;
+inline BigInteger operator+(const BigInteger& lhs, BigInteger&& rhs) {
+    rhs += lhs;
+    return std::move(rhs);
 }
 
 inline BigInteger operator-(BigInteger lhs, const BigInteger& rhs) {
-    BigInteger temp(rhs);
-    setSign(temp, -getSign(rhs));
-    return temp + lhs;
+    lhs -= rhs;
+    return lhs;
+}
+
+inline BigInteger operator-(const BigInteger& lhs, BigInteger&& rhs) {
+    // lhs - rhs == -(rhs - lhs)
+    rhs -= lhs;
+    setSign(rhs, -getSign(rhs));
+    return std::move(rhs);
 }
 
 inline BigInteger operator*(BigInteger lhs, const BigInteger& rhs) {
-    BigInteger result;
-    auto ln = getNumber(lhs);
-    auto rn = getNumber(rhs);
-    auto rs = getSign(rhs);
-    auto ls = getSign(lhs);
-    auto zero = std::vector<int>{ 0 };
-    auto one = std::vector<int>{ 1 };
-    if ((ln == zero) || (rn == zero)) return BigInteger(0);
-    if (ln == one) return BigInteger(rhs);
-    if (rn == one) return BigInteger(lhs);
-    auto resultNum = naive_mul(ln, rn);
-
-    setNumber(result, resultNum);
-    setSign(result, rs * ls);
+    lhs *= rhs;
+    return lhs;
+}
 
-    return result;
+inline BigInteger operator*(const BigInteger& lhs, BigInteger&& rhs) {
+    rhs *= lhs;
+    return std::move(rhs);
 }
 
 
-inline BigInteger operator/(BigInteger lhs, const BigInteger& rhs) {
-    auto b = rhs;
-    if (getNumber(rhs) == std::vector<int>{0}) {
+// quotient and remainder from a single division, the quotient is truncated
+// toward zero and the remainder takes the sign of lhs, as for built-in integers
+inline std::pair<BigInteger, BigInteger> divmod(const BigInteger& lhs, const BigInteger& rhs) {
+    if (rhs.number.empty()) {
         throw std::runtime_error("Division by zero");
     }
 
-    BigInteger quotient(0);
-    BigInteger remainder(0);
-    int quotientSign = getSign(lhs) * getSign(b);
-
-    setSign(lhs, 1);
-    setSign(b, 1);
-
-    for (int digit : getNumber(lhs)) {
-        remainder = remainder * 10 + BigInteger(digit);
-        int count = 0;
-        while (remainder >= b) {
-            remainder -= b;
-            count++;
-        }
-        auto qNum = getNumber(quotient);
-        qNum.push_back(count);
-        setNumber(quotient, qNum);
-    }
-
-
-    auto quotientNum = getNumber(quotient);
-    auto it = std::find_if(quotientNum.begin(), quotientNum.end(), [](int x) { return x != 0; });
-    quotientNum.erase(quotientNum.begin(), it);
-    if (quotientNum.empty()) {
-        quotientNum.push_back(0);
-    }
-    setNumber(quotient, quotientNum);
-    setSign(quotient, quotientSign);
+    std::pair<BigInteger, BigInteger> result;
+    divideMagnitude(lhs.number, rhs.number, result.first.number, result.second.number);
+    setSign(result.first, lhs.sign * rhs.sign);
+    setSign(result.second, lhs.sign);
+    return result;
+}
 
-    return quotient;
+inline BigInteger operator/(BigInteger lhs, const BigInteger& rhs) {
+    return std::move(divmod(lhs, rhs).first);
 }
 
 inline BigInteger operator%(BigInteger lhs, const BigInteger& rhs) {
-    auto a = abs(lhs);
-    auto b = abs(rhs);
-    BigInteger quotient = a / b;
-    BigInteger product = quotient * b;
-    auto res = a - product;
-    return res;
+    return std::move(divmod(lhs, rhs).second);
 }
 
 // alternatively you can implement
@@ -353,40 +648,12 @@ inline bool operator<(const BigInteger& lhs, const BigInteger& rhs) {
     if (getSign(lhs) != getSign(rhs)) {
         return getSign(lhs) < getSign(rhs);
     }
-    const auto& ln = getNumber(lhs);
-    const auto& rn = getNumber(rhs);
-    if (ln.size() != rn.size()) {
-        return getSign(lhs) == 1 ? ln.size() < rn.size() : ln.size() > rn.size();
-    }
-    return getSign(lhs) == 1 ? ln < rn : ln > rn;
+    int cmp = compareMagnitude(getNumber(lhs), getNumber(rhs));
+    return getSign(lhs) == 1 ? cmp < 0 : cmp > 0;
 }
 
 inline bool operator>(const BigInteger& lhs, const BigInteger& rhs) {
-    auto ln = getNumber(lhs);
-    auto rn = getNumber(rhs);
-    auto rs = getSign(rhs);
-    auto ls = getSign(lhs);
-    if (ls != rs) {
-        if (ls == -1) return false;
-        else if (ls == 1) return true;
-    }
-    else if (ls == 1) // both +ve
-    {
-        if (ln.size() > rn.size())
-            return true;
-        if (ln.size() < rn.size())
-            return false;
-        return ln > rn;
-    }
-    else // both -ve
-    {
-        if (ln.size() > rn.size())
-            return false;
-        if (ln.size() < rn.size())
-            return true;
-        return !(ln > rn);
-    }
-    return false;
+    return rhs < lhs;
 }
 
 inline bool operator<=(const BigInteger& lhs, const BigInteger& rhs) {
@@ -397,40 +664,154 @@ inline bool operator>=(const BigInteger& lhs, const BigInteger& rhs) {
     return lhs > rhs || lhs == rhs;
 }
 
+// std::hex and std::oct pick the base of stream text, anything else is decimal
+inline int streamBase(std::ios::fmtflags flags) {
+    switch (flags & std::ios::basefield) {
+    case std::ios::hex:
+        return 16;
+    case std::ios::oct:
+        return 8;
+    default:
+        return 10;
+    }
+}
+
+// one insertion of the whole text, so a field width applies to the sign too,
+// std::showbase and std::uppercase work as they do for int, the prefix goes
+// between the sign and the digits
 inline std::ostream& operator<<(std::ostream& lhs, const BigInteger& rhs) {
-    if (rhs.sign == -1 && !(rhs.number.size() == 1 && rhs.number[0] == 0)) lhs << '-';
-    for (int digit : rhs.number) {
-        lhs << digit;
+    const std::ios::fmtflags flags = lhs.flags();
+    const int base = streamBase(flags);
+    if (base == 10) return lhs << rhs.toString();
+
+    std::string text = rhs.toString(base);
+    if (flags & std::ios::uppercase) {
+        for (char& c : text) c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
     }
-    return lhs;
+    if ((flags & std::ios::showbase) && !rhs.number.empty()) {
+        const char* prefix = base == 8 ? "0" : (flags & std::ios::uppercase) ? "0X" : "0x";
+        text.insert(rhs.sign < 0 ? 1 : 0, prefix);
+    }
+    return lhs << text;
+}
+
+// reads an optional '-' and the longest run of base digits like std::from_chars,
+// value is left untouched and ptr == first when no digit matches
+inline std::from_chars_result from_chars(const char* first, const char* last, BigInteger& value, int base) {
+    if (base < 2 || base > 36) return { first, std::errc::invalid_argument };
+    const bool negative = first != last && *first == '-';
+    const char* digits = negative ? first + 1 : first;
+    const char* end = skipRadixDigits(digits, last, base);
+    if (end == digits) return { first, std::errc::invalid_argument };
+
+    while (digits != end && *digits == '0') ++digits;
+    value.number = parseRadix(digits, end, base);
+    value.sign = negative && !value.number.empty() ? -1 : 1;
+    return { end, std::errc() };
+}
+
+// writes value in base to [first, last) like std::to_chars, without a
+// terminator, a short range gives value_too_large and ptr == last
+inline std::to_chars_result to_chars(char* first, char* last, const BigInteger& value, int base) {
+    if (base < 2 || base > 36) return { last, std::errc::invalid_argument };
+    if (value.sign == -1 && !value.number.empty()) {
+        if (first == last) return { last, std::errc::value_too_large };
+        *first++ = '-';
+    }
+
+    const size_t available = static_cast<size_t>(last - first);
+    const size_t size = radixBufferSize(value.number, base);
+    if (size <= available) return { writeRadix(value.number, first, base), std::errc() };
+
+    // the reserve may exceed the digits by a chunk, so a tight range is
+    // formatted aside first
+    std::string digits(size, '0');
+    const size_t length = static_cast<size_t>(writeRadix(value.number, digits.data(), base) - digits.data());
+    if (length > available) return { last, std::errc::value_too_large };
+    std::memcpy(first, digits.data(), length);
+    return { first + length, std::errc() };
 }
 
 #if SUPPORT_IFSTREAM == 1
 
+// reads a [+-]digits token in base straight from the stream buffer, the
+// digits are packed into chunk words as they arrive and joined into limbs
+// once at the end; it stops before whitespace, the end of the input or stop,
+// which stay in the stream, a hex "0x" is skipped and any other char is
+// consumed with the rest of the token and makes it invalid, value is only
+// set for a valid token
+inline bool readNumber(std::istream& in, BigInteger& value, int stop, int base) {
+    using traits = std::istream::traits_type;
+    std::streambuf* buffer = in.rdbuf();
+    const std::ctype<char>& ctype = std::use_facet<std::ctype<char>>(in.getloc());
+    // a power of two base packs whole bit fields into a word
+    uint64_t power = 0;
+    const size_t chunkDigits = std::has_single_bit(static_cast<unsigned>(base))
+        ? 64 / static_cast<size_t>(std::countr_zero(static_cast<unsigned>(base))) : radixChunkDigits(base, power);
+    LimbVector words;
+    uint64_t chunk = 0, scale = 1;
+    size_t chunkSize = 0, digits = 0;
+    bool valid = true, negative = false, significant = false, first = true, prefix = false;
+    for (int c = buffer->sgetc();; c = buffer->snextc(), first = false) {
+        if (traits::eq_int_type(c, traits::eof())) {
+            in.setstate(std::ios::eofbit);
+            break;
+        }
+        const char ch = traits::to_char_type(c);
+        if (c == stop || ctype.is(std::ctype_base::space, ch)) break;
+        const int digit = radixDigitValue(ch);
+        if (digit < base) {
+            ++digits;
+            // leading zeros never reach the chunks
+            if (digit == 0 && !significant) continue;
+            significant = true;
+            chunk = chunk * static_cast<uint64_t>(base) + static_cast<uint64_t>(digit);
+            scale *= static_cast<uint64_t>(base);
+            if (++chunkSize == chunkDigits) {
+                words.push_back(chunk);
+                chunk = 0;
+                scale = 1;
+                chunkSize = 0;
+            }
+        }
+        else if (first && (ch == '-' || ch == '+')) {
+            negative = ch == '-';
+        }
+        else if (base == 16 && (ch == 'x' || ch == 'X') && !prefix && digits == 1 && !significant) {
+            digits = 0;
+            prefix = true;
+        }
+        else {
+            valid = false;
+        }
+    }
+    if (!valid || digits == 0) return false;
+
+    value.number = joinRadixChunks(words.data(), words.size(), base, chunkDigits, power);
+    mulAddSmall(value.number, scale, chunk);
+    value.sign = negative && !value.number.empty() ? -1 : 1;
+    return true;
+}
+
 // this should behave exactly the same as reading int with respect to
-// whitespace, consumed characters etc...
+// whitespace, consumed characters etc... the digits go from the stream
+// buffer into limbs a chunk at a time, a bad token sets failbit and leaves
+// rhs alone
 inline std::istream& operator>>(std::istream& lhs, BigInteger& rhs) {
-    std::string input;
-    lhs >> input;
-
-    if (input.empty() || (input.size() == 1 && input[0] == '-')) {
-        lhs.setstate(std::ios::failbit);
-        return lhs;
-    }
+    std::istream::sentry sentry(lhs);
+    if (!sentry) return lhs;
 
-    try {
-        rhs = BigInteger(input);
-    }
-    catch (const std::invalid_argument&) {
+    if (!readNumber(lhs, rhs, std::istream::traits_type::eof(), streamBase(lhs.flags()))) {
         lhs.setstate(std::ios::failbit);
     }
-
     return lhs;
 } // bonus
 #endif
 
 BigInteger gcd(const BigInteger& a, const BigInteger& b);
 
+BigInteger extendedGcd(const BigInteger& a, const BigInteger& b, BigInteger& x, BigInteger& y);
+
 uint64_t gcd64(const uint64_t& a, const uint64_t& b);
 
 void normalizeInner(BigInteger& numerator, BigInteger& denominator);
@@ -456,12 +837,13 @@ public:
 
     BigRational(int64_t a, int64_t b) {
         if (b == 0) throw std::runtime_error("invalid argument - zero denominator.");
-        auto num = std::make_unsigned_t<int64_t>(a);
-        auto denom = std::make_unsigned_t<int64_t>(b);
-        auto d = gcd64(num, denom);
-        numerator = BigInteger(static_cast<int64_t>(a / d));
-        denominator = BigInteger(static_cast<int64_t>(b / d));
-        //normalizeInner(numerator, denominator);
+        // magnitudes as unsigned words, so INT64_MIN has one too
+        uint64_t num = a < 0 ? 0 - static_cast<uint64_t>(a) : static_cast<uint64_t>(a);
+        uint64_t denom = b < 0 ? 0 - static_cast<uint64_t>(b) : static_cast<uint64_t>(b);
+        uint64_t d = gcd64(num, denom);
+        setNumber(numerator, LimbVector{ num / d });
+        setSign(numerator, (a < 0) == (b < 0) ? 1 : -1);
+        setNumber(denominator, LimbVector{ denom / d });
     }
     //    if (b[0] == '0' && b.size() == 1) throw std::runtime_error("invalid argument - zero denominator.");
     //    numerator = BigInteger(a);
@@ -478,17 +860,24 @@ public:
         normalizeInner(numerator, denominator);
     }
 
-    // copy
-    BigRational(const BigRational& other) {
-        numerator = other.numerator;
-        denominator = other.denominator;
-        normalizeInner(numerator, denominator);
+    // every constructor and operator leaves the value in lowest terms with a
+    // positive denominator, so copies are plain member copies
+    BigRational(const BigRational& other) = default;
+
+    BigRational& operator=(const BigRational& rhs) = default;
+
+    // move, the source is left as zero
+    BigRational(BigRational&& other) noexcept
+        : numerator(std::move(other.numerator)), denominator(std::move(other.denominator)) {
+        other.denominator = BigInteger(1);
     }
 
-    BigRational& operator=(const BigRational& rhs) {
-        numerator = rhs.numerator;
-        denominator = rhs.denominator;
-        normalizeInner(numerator, denominator);
+    BigRational& operator=(BigRational&& rhs) noexcept {
+        if (this != &rhs) {
+            numerator = std::move(rhs.numerator);
+            denominator = std::move(rhs.denominator);
+            rhs.denominator = BigInteger(1);
+        }
         return *this;
     }
 
@@ -524,6 +913,14 @@ public:
         return *this;
     }
 
+    // back to lowest terms with a positive denominator, for terms that were
+    // set through setNumerator and setDenominator
+    BigRational& normalize() {
+        if (getNumber(denominator).empty()) throw std::runtime_error("Denominator cannot be zero");
+        normalizeInner(numerator, denominator);
+        return *this;
+    }
+
     double sqrt() const {
         int sign = getSign(numerator) * getSign(denominator);
         if (sign < 0) throw std::invalid_argument("invalid argument - negative number.");
@@ -549,6 +946,8 @@ private:
 
     friend BigRational createBigRational(const BigInteger& a, const BigInteger& b);
 
+    friend inline std::istream& readBinaryValue(std::istream& in, BigRational& value);
+
     friend BigInteger gcd(const BigInteger& a, const BigInteger& b);
 
     friend int getSign(const BigInteger& bigInt);
@@ -563,86 +962,215 @@ BigRational createBigRational(const BigInteger& a, const BigInteger& b);
 
 BigRational normalize(BigInteger numerator, BigInteger denominator);
 
-inline BigRational operator+(BigRational lhs, const BigRational& rhs) {
-    BigInteger d1 = getDenominator(lhs), d2 = getDenominator(rhs);
-    BigInteger n1 = getNumerator(lhs), n2 = getNumerator(rhs);
-    BigInteger commonDenominator;
-    if (d1 != d2) {
-        commonDenominator = d1 * d2;
-        BigInteger lhsNumerator = n1 * d2;
-        BigInteger rhsNumerator = n2 * d1;
-        return normalize(lhsNumerator + rhsNumerator, commonDenominator);
+// the terms of a fraction as single words, false when either one is longer
+inline bool wordTerms(const BigRational& x, uint64_t& numerator, uint64_t& denominator) {
+    const LimbVector& n = getNumber(getNumerator(x));
+    const LimbVector& d = getNumber(getDenominator(x));
+    if (n.size() > 1 || d.size() > 1) return false;
+    numerator = n.empty() ? 0 : n[0];
+    denominator = d[0];
+    return true;
+}
+
+// sign * (numHi:numLo) / (denHi:denLo) for terms already in lowest terms,
+// both fit the inline limbs of a BigInteger
+inline BigRational wordFraction(int sign, uint64_t numHi, uint64_t numLo, uint64_t denHi, uint64_t denLo) {
+    BigInteger numerator, denominator;
+    setNumber(numerator, LimbVector{ numLo, numHi });
+    setSign(numerator, sign);
+    setNumber(denominator, LimbVector{ denLo, denHi });
+    return createBigRational(numerator, denominator);
+}
+
+// Henrici's sum below for single-word terms in 128-bit arithmetic, false when
+// the numerator would not fit 128 bits and the long way has to be taken
+inline bool addWordFractions(uint64_t n1, uint64_t d1, int sign1, uint64_t n2, uint64_t d2, int sign2, BigRational& result) {
+    const uint64_t g = gcd64(d1, d2);
+    const uint64_t s = d1 / g;
+    uint64_t hi1, hi2;
+    uint64_t lo1 = mulWide(n1, d2 / g, hi1);
+    uint64_t lo2 = mulWide(n2, s, hi2);
+    int sign = sign1;
+    uint64_t hi, lo;
+    if (sign1 == sign2) {
+        lo = lo1 + lo2;
+        const uint64_t partial = hi1 + hi2;
+        hi = partial + (lo < lo1);
+        if (partial < hi1 || hi < partial) return false;
     }
     else {
-        commonDenominator = d1;
-        return normalize(n1 + n2, commonDenominator);
+        // the difference of the magnitudes takes the sign of the larger one
+        if (hi1 < hi2 || (hi1 == hi2 && lo1 < lo2)) {
+            std::swap(hi1, hi2);
+            std::swap(lo1, lo2);
+            sign = sign2;
+        }
+        lo = lo1 - lo2;
+        hi = hi1 - hi2 - (lo1 < lo2);
+    }
+    if (hi == 0 && lo == 0) {
+        result = BigRational();
+        return true;
+    }
+
+    uint64_t h = 1, rem;
+    if (g != 1) {
+        divWide(hi % g, lo, g, rem);
+        h = gcd64(rem, g);
+    }
+    if (h != 1) {
+        rem = hi % h;
+        hi /= h;
+        lo = divWide(rem, lo, h, rem);
     }
+    uint64_t denHi;
+    const uint64_t denLo = mulWide(s, d2 / h, denHi);
+    result = wordFraction(sign, hi, lo, denHi, denLo);
+    return true;
 }
 
-inline BigRational operator-(BigRational lhs, const BigRational& rhs) {
-    BigInteger d1 = getDenominator(lhs), d2 = getDenominator(rhs);
-    BigInteger n1 = getNumerator(lhs), n2 = getNumerator(rhs);
-    BigInteger commonDenominator;
-    if (d1 != d2) {
-        commonDenominator = d1 * d2;
-        BigInteger lhsNumerator = n1 * d2;
-        BigInteger rhsNumerator = n2 * d1;
-        return normalize(lhsNumerator - rhsNumerator, commonDenominator);
+// cross-cancelled product below for single-word terms, it always fits 128 bits
+inline BigRational multiplyWordFractions(uint64_t n1, uint64_t d1, uint64_t n2, uint64_t d2, int sign) {
+    const uint64_t g1 = gcd64(n1, d2), g2 = gcd64(n2, d1);
+    uint64_t numHi, denHi;
+    const uint64_t numLo = mulWide(n1 / g1, n2 / g2, numHi);
+    const uint64_t denLo = mulWide(d1 / g2, d2 / g1, denHi);
+    return wordFraction(sign, numHi, numLo, denHi, denLo);
+}
+
+// Henrici's sum of canonical fractions (TAOCP 4.5.1): with g = gcd(d1, d2)
+// only a factor of g can be left in t = n1 * (d2 / g) + n2 * (d1 / g), so the
+// products and the final gcd stay about as long as the operands
+inline BigRational addFractions(const BigInteger& n1, const BigInteger& d1, const BigInteger& n2, const BigInteger& d2) {
+    BigInteger g = gcd(d1, d2);
+    if (g == BigInteger(1)) {
+        return createBigRational(n1 * d2 + n2 * d1, d1 * d2);
+    }
+    BigInteger s = d1 / g;
+    BigInteger t = n1 * (d2 / g) + n2 * s;
+    if (t == BigInteger(0)) return BigRational();
+    BigInteger h = gcd(t, g);
+    if (h == BigInteger(1)) return createBigRational(t, s * d2);
+    return createBigRational(t / h, s * (d2 / h));
+}
+
+// product of canonical fractions, n1 / d1 and n2 / d2 are already coprime, so
+// cancelling across with gcd(n1, d2) and gcd(n2, d1) leaves it in lowest terms
+inline BigRational multiplyFractions(const BigInteger& n1, const BigInteger& d1, const BigInteger& n2, const BigInteger& d2) {
+    BigInteger g1 = gcd(n1, d2), g2 = gcd(n2, d1);
+    if (g1 == BigInteger(1) && g2 == BigInteger(1)) {
+        return createBigRational(n1 * n2, d1 * d2);
     }
-    else {
-        commonDenominator = d1;
-        return normalize(n1 - n2, commonDenominator);
+    return createBigRational((n1 / g1) * (n2 / g2), (d1 / g2) * (d2 / g1));
+}
+
+inline BigRational operator+(BigRational lhs, const BigRational& rhs) {
+    uint64_t n1, d1, n2, d2;
+    BigRational result;
+    if (wordTerms(lhs, n1, d1) && wordTerms(rhs, n2, d2)
+        && addWordFractions(n1, d1, getSign(getNumerator(lhs)), n2, d2, getSign(getNumerator(rhs)), result)) {
+        return result;
+    }
+    return addFractions(getNumerator(lhs), getDenominator(lhs), getNumerator(rhs), getDenominator(rhs));
+}
+
+inline BigRational operator-(BigRational lhs, const BigRational& rhs) {
+    uint64_t n1, d1, n2, d2;
+    BigRational result;
+    if (wordTerms(lhs, n1, d1) && wordTerms(rhs, n2, d2)
+        && addWordFractions(n1, d1, getSign(getNumerator(lhs)), n2, d2, -getSign(getNumerator(rhs)), result)) {
+        return result;
     }
+    return addFractions(getNumerator(lhs), getDenominator(lhs), -getNumerator(rhs), getDenominator(rhs));
 }
 
 inline BigRational operator*(BigRational lhs, const BigRational& rhs) {
-    BigInteger commonDenominator = getDenominator(lhs) * getDenominator(rhs);
-    auto num = getNumerator(lhs) * getNumerator(rhs);
-    //int sign = getSign(getNumerator(lhs)) * getSign(getNumerator(rhs))
-    return normalize(num, commonDenominator);
+    uint64_t n1, d1, n2, d2;
+    if (wordTerms(lhs, n1, d1) && wordTerms(rhs, n2, d2)) {
+        return multiplyWordFractions(n1, d1, n2, d2, getSign(getNumerator(lhs)) * getSign(getNumerator(rhs)));
+    }
+    return multiplyFractions(getNumerator(lhs), getDenominator(lhs), getNumerator(rhs), getDenominator(rhs));
 }
 
 inline BigRational operator/(BigRational lhs, const BigRational& rhs) {
-    return normalize(getNumerator(lhs) * getDenominator(rhs), getNumerator(rhs) * getDenominator(lhs));
+    if (getNumerator(rhs) == BigInteger(0)) {
+        throw std::runtime_error("Division by zero");
+    }
+    uint64_t n1, d1, n2, d2;
+    if (wordTerms(lhs, n1, d1) && wordTerms(rhs, n2, d2)) {
+        return multiplyWordFractions(n1, d1, d2, n2, getSign(getNumerator(lhs)) * getSign(getNumerator(rhs)));
+    }
+    // times the reciprocal, with its sign moved up to the numerator
+    BigInteger numerator = getDenominator(rhs);
+    setSign(numerator, getSign(getNumerator(rhs)));
+    return multiplyFractions(getNumerator(lhs), getDenominator(lhs), numerator, abs(getNumerator(rhs)));
 }
 
 
 // alternatively you can implement
 // std::strong_ordering operator<=>(const BigRational& lhs, const BigRational& rhs);
 // idea is, that all comparison should work, it is not important how you do it
+
+// three-way comparison of canonical fractions by sign first, then by the
+// lengths of n1 * d2 and n2 * d1, which are the sums of the operand lengths or
+// one bit less, and only when those are too close by the products themselves,
+// formed in 128-bit words when all terms are single words
+inline int compareFractions(const BigRational& lhs, const BigRational& rhs) {
+    const LimbVector& n1 = getNumber(getNumerator(lhs));
+    const LimbVector& d1 = getNumber(getDenominator(lhs));
+    const LimbVector& n2 = getNumber(getNumerator(rhs));
+    const LimbVector& d2 = getNumber(getDenominator(rhs));
+    const int sign1 = n1.empty() ? 0 : getSign(getNumerator(lhs));
+    const int sign2 = n2.empty() ? 0 : getSign(getNumerator(rhs));
+    if (sign1 != sign2) return sign1 < sign2 ? -1 : 1;
+    if (sign1 == 0) return 0;
+
+    int cmp;
+    uint64_t w1, v1, w2, v2;
+    const size_t left = bitLength(n1) + bitLength(d2);
+    const size_t right = bitLength(n2) + bitLength(d1);
+    if (left > right + 1) cmp = 1;
+    else if (right > left + 1) cmp = -1;
+    else if (wordTerms(lhs, w1, v1) && wordTerms(rhs, w2, v2)) {
+        uint64_t hi1, hi2;
+        const uint64_t lo1 = mulWide(w1, v2, hi1);
+        const uint64_t lo2 = mulWide(w2, v1, hi2);
+        cmp = hi1 != hi2 ? (hi1 < hi2 ? -1 : 1) : lo1 != lo2 ? (lo1 < lo2 ? -1 : 1) : 0;
+    }
+    else if (compareMagnitude(d1, d2) == 0) cmp = compareMagnitude(n1, n2);
+    else cmp = compareMagnitude(multiply(n1, d2), multiply(n2, d1));
+    return sign1 * cmp;
+}
+
+// canonical fractions are equal exactly when their terms are
 inline bool operator==(const BigRational& lhs, const BigRational& rhs) {
-    return (getNumerator(lhs) * getDenominator(rhs)) == (getNumerator(rhs) * getDenominator(lhs));
+    return getNumerator(lhs) == getNumerator(rhs) && getDenominator(lhs) == getDenominator(rhs);
 }
 
 inline bool operator!=(const BigRational& lhs, const BigRational& rhs) {
-    return (getNumerator(lhs) * getDenominator(rhs)) != (getNumerator(rhs) * getDenominator(lhs));
+    return !(lhs == rhs);
 }
 
 inline bool operator<(const BigRational& lhs, const BigRational& rhs) {
-    //BigInteger commonDenominator = getDenominator(lhs) * getDenominator(rhs);
-    BigInteger lhsNumerator = getNumerator(lhs) * getDenominator(rhs);
-    BigInteger rhsNumerator = getNumerator(rhs) * getDenominator(lhs);
-    return lhsNumerator < rhsNumerator;
+    return compareFractions(lhs, rhs) < 0;
 }
 
 inline bool operator>(const BigRational& lhs, const BigRational& rhs) {
-    BigInteger lhsNumerator = getNumerator(lhs) * getDenominator(rhs);
-    BigInteger rhsNumerator = getNumerator(rhs) * getDenominator(lhs);
-    return lhsNumerator > rhsNumerator;
+    return compareFractions(lhs, rhs) > 0;
 }
 
 inline bool operator<=(const BigRational& lhs, const BigRational& rhs) {
-    return ((lhs == rhs) || (lhs < rhs));
+    return compareFractions(lhs, rhs) <= 0;
 }
 
 inline bool operator>=(const BigRational& lhs, const BigRational& rhs) {
-    return ((lhs == rhs) || (lhs > rhs));
+    return compareFractions(lhs, rhs) >= 0;
 }
 
 inline std::ostream& operator<<(std::ostream& out, const BigRational& rhs) {
     if (getSign(getNumerator(rhs)) * getSign(getDenominator(rhs)) < 0) {
         //if not zero
-        if (!(getNumber(rhs.numerator).size() == 1 && (getNumber(rhs.numerator)[0] == 0)))
+        if (!getNumber(rhs.numerator).empty())
             out << '-';
     }
 
@@ -662,42 +1190,27 @@ inline std::ostream& operator<<(std::ostream& out, const BigRational& rhs) {
 // this should behave exactly the same as reading int with respect to
 // whitespace, consumed characters etc...
 inline std::istream& operator>>(std::istream& lhs, BigRational& rhs) {
-    std::string numeratorStr, denominatorStr;
-    char delimiter;
-
-    lhs >> numeratorStr;
-    if (numeratorStr.empty() || (numeratorStr.size() == 1 && numeratorStr[0] == '-')) {
+    std::istream::sentry sentry(lhs);
+    if (!sentry) return lhs;
+
+    // one token: the numerator, then an optional '/' right after it and the
+    // denominator, the whitespace that ends the token stays in the stream
+    BigInteger numerator, denominator(1);
+    const int base = streamBase(lhs.flags());
+    if (!readNumber(lhs, numerator, '/', base)) {
         lhs.setstate(std::ios::failbit);
         return lhs;
     }
-
-    lhs >> std::ws >> delimiter;
-    if (!lhs || delimiter != '/') {
-        try {
-            BigInteger numerator(numeratorStr);
-            rhs = createBigRational(numerator, BigInteger(1));
-        }
-        catch (const std::invalid_argument&) {
+    std::streambuf* buffer = lhs.rdbuf();
+    if (!lhs.eof() && buffer->sgetc() == '/') {
+        buffer->sbumpc();
+        if (!readNumber(lhs, denominator, std::istream::traits_type::eof(), base) || getNumber(denominator).empty()) {
             lhs.setstate(std::ios::failbit);
+            return lhs;
         }
-        return lhs;
-    }
-
-    lhs >> denominatorStr;
-    if (denominatorStr.empty()) {
-        lhs.setstate(std::ios::failbit);
-        return lhs;
-    }
-
-    try {
-        BigInteger numerator(numeratorStr);
-        BigInteger denominator(denominatorStr);
-        rhs = createBigRational(numerator, denominator);
-    }
-    catch (const std::invalid_argument&) {
-        lhs.setstate(std::ios::failbit);
     }
 
+    rhs = normalize(numerator, denominator);
     return lhs;
 } // bonus
 #endif
@@ -707,155 +1220,1638 @@ inline BigInteger eval(const std::string&);
 #endif
 
 
-std::vector<int> add(const std::vector<int>& lhs, const std::vector<int>& rhs) {
-    std::vector<int> result;
-    int carry = 0;
-    size_t maxLength = std::max(lhs.size(), rhs.size());
+void trimLimbs(LimbVector& num) {
+    while (!num.empty() && num.back() == 0) {
+        num.pop_back();
+    }
+}
 
-    for (size_t i = 0; i < maxLength || carry; ++i) {
-        int sum = carry;
-        if (i < lhs.size()) sum += lhs[lhs.size() - 1 - i];
-        if (i < rhs.size()) sum += rhs[rhs.size() - 1 - i];
-        carry = sum / 10;
-        sum %= 10;
-        result.push_back(sum);
+// three-way comparison of trimmed magnitudes a[0..an) and b[0..bn)
+int compareLimbs(const uint64_t* a, size_t an, const uint64_t* b, size_t bn) {
+    if (an != bn) {
+        return an < bn ? -1 : 1;
     }
+    for (size_t i = an; i-- > 0;) {
+        if (a[i] != b[i]) {
+            return a[i] < b[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
 
-    std::reverse(result.begin(), result.end());
-    return result;
+int compareMagnitude(const LimbVector& lhs, const LimbVector& rhs) {
+    return compareLimbs(lhs.data(), lhs.size(), rhs.data(), rhs.size());
 }
 
-std::vector<int> subtract(const std::vector<int>& lhs, const std::vector<int>& rhs) {
+// number of significant bits, zero for zero
+size_t bitLength(const LimbVector& num) {
+    if (num.empty()) return 0;
+    return 64 * num.size() - std::countl_zero(num.back());
+}
 
-    auto a = lhs;
-    auto b = rhs;
+// num = num * mul + add
+void mulAddSmall(LimbVector& num, uint64_t mul, uint64_t add) {
+    uint64_t carry = add;
+    for (uint64_t& limb : num) {
+        uint64_t hi;
+        uint64_t lo = mulWide(limb, mul, hi);
+        lo += carry;
+        hi += lo < carry;
+        limb = lo;
+        carry = hi;
+    }
+    if (carry != 0) num.push_back(carry);
+}
 
-    if (a.size() < b.size() || (a.size() == b.size() && a < b)) {
-        std::swap(a, b);
+// num = num / divisor, returns the remainder
+uint64_t divSmall(LimbVector& num, uint64_t divisor) {
+    uint64_t rem = 0;
+    for (size_t i = num.size(); i-- > 0;) {
+        num[i] = divWide(rem, num[i], divisor, rem);
     }
+    trimLimbs(num);
+    return rem;
+}
 
+// 10^(19 * 2^k), squared up once per thread, a deque keeps the references
+// handed out stable while the table grows
+const LimbVector& decimalPower(size_t k) {
+    thread_local std::deque<LimbVector> powers{ LimbVector{ DECIMAL_CHUNK_BASE } };
+    while (powers.size() <= k) powers.push_back(square(powers.back()));
+    return powers[k];
+}
 
-    b.insert(b.begin(), a.size() - b.size(), 0);
+// writes chunk < 10^19 as exactly 19 digits
+inline void writeDecimalChunk(uint64_t chunk, char* out) {
+    for (size_t i = DECIMAL_CHUNK_DIGITS; i-- > 0;) {
+        out[i] = static_cast<char>('0' + chunk % 10);
+        chunk /= 10;
+    }
+}
 
-    std::vector<int> result;
-    int borrow = 0;
+// writes x < 10^(19 * chunks) as exactly 19 * chunks digits, long values are
+// split by the largest cached power below and both halves written in place
+void writeDecimalChunks(const LimbVector& x, char* out, size_t chunks) {
+    if (x.size() < BIGNUM_DECIMAL_THRESHOLD) {
+        LimbVector rest = x;
+        for (size_t i = chunks; i-- > 0;) {
+            writeDecimalChunk(rest.empty() ? 0 : divSmall(rest, DECIMAL_CHUNK_BASE), out + i * DECIMAL_CHUNK_DIGITS);
+        }
+        return;
+    }
 
+    size_t low = 1, k = 0;
+    while (2 * low < chunks) {
+        low *= 2;
+        ++k;
+    }
+    LimbVector q, r;
+    divideMagnitude(x, decimalPower(k), q, r);
+    writeDecimalChunks(q, out, chunks - low);
+    writeDecimalChunks(r, out + (chunks - low) * DECIMAL_CHUNK_DIGITS, low);
+}
 
-    for (int i = static_cast<int>(a.size() - 1); i >= 0; --i) {
-        int digitA = a[i];
-        int digitB = b[i] + borrow;
+const char RADIX_DIGITS[] = "0123456789abcdefghijklmnopqrstuvwxyz";
 
-        if (digitA < digitB) {
-            digitA += 10;
-            borrow = 1;
+// value of c as a digit in bases up to 36, 36 for anything else
+inline int radixDigitValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'z') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'Z') return c - 'A' + 10;
+    return 36;
+}
+
+// number of base digits one limb chunk holds, power is base to that number
+inline size_t radixChunkDigits(int base, uint64_t& power) {
+    const uint64_t b = static_cast<uint64_t>(base);
+    size_t digits = 1;
+    for (power = b; power <= std::numeric_limits<uint64_t>::max() / b; power *= b) ++digits;
+    return digits;
+}
+
+// chars reserved for the digits of num: bitLength / log2(base) digits are
+// enough, rounded up to whole chunks, and exact for powers of two
+size_t radixBufferSize(const LimbVector& num, int base) {
+    if (num.empty()) return 1;
+    if (std::has_single_bit(static_cast<unsigned>(base))) {
+        const size_t bits = static_cast<size_t>(std::countr_zero(static_cast<unsigned>(base)));
+        return (bitLength(num) + bits - 1) / bits;
+    }
+    uint64_t power;
+    const size_t chunkDigits = radixChunkDigits(base, power);
+    size_t digits = static_cast<size_t>(static_cast<double>(bitLength(num)) / std::log2(base)) + 2;
+    return (digits + chunkDigits - 1) / chunkDigits * chunkDigits;
+}
+
+// writes the digits of num to out[0, radixBufferSize), the spare leading
+// zeros are cut off once at the end, returns the end of the digits
+char* writeRadix(const LimbVector& num, char* out, int base) {
+    if (num.empty()) {
+        *out = '0';
+        return out + 1;
+    }
+
+    // powers of two are bit fields of the limbs, most significant digit first
+    const size_t size = radixBufferSize(num, base);
+    if (std::has_single_bit(static_cast<unsigned>(base))) {
+        const size_t bits = static_cast<size_t>(std::countr_zero(static_cast<unsigned>(base)));
+        const uint64_t mask = static_cast<uint64_t>(base - 1);
+        for (size_t i = 0, bit = (size - 1) * bits; i < size; ++i, bit -= bits) {
+            const size_t limb = bit / 64, shift = bit % 64;
+            uint64_t value = num[limb] >> shift;
+            if (shift + bits > 64 && limb + 1 < num.size()) value |= num[limb + 1] << (64 - shift);
+            out[i] = RADIX_DIGITS[value & mask];
         }
-        else {
-            borrow = 0;
+        return out + size;
+    }
+
+    uint64_t power;
+    const size_t chunkDigits = radixChunkDigits(base, power);
+    if (base == 10) {
+        writeDecimalChunks(num, out, size / chunkDigits);
+    }
+    else {
+        LimbVector rest = num;
+        for (char* chunk = out + size; chunk != out; chunk -= chunkDigits) {
+            uint64_t value = rest.empty() ? 0 : divSmall(rest, power);
+            for (char* p = chunk; p != chunk - chunkDigits; value /= static_cast<uint64_t>(base)) {
+                *--p = RADIX_DIGITS[value % static_cast<uint64_t>(base)];
+            }
         }
+    }
+
+    const char* digits = std::find_if(out, out + size, [](char c) { return c != '0'; });
+    const size_t length = static_cast<size_t>(out + size - digits);
+    std::memmove(out, digits, length);
+    return out + length;
+}
+
+// eight ASCII bytes loaded little-endian, each one checked for '0'..'9' at once:
+// the high nibble must be 3 and adding 6 must not carry out of the low one
+inline bool isEightDigits(uint64_t bytes) {
+    return ((bytes & 0xF0F0F0F0F0F0F0F0ULL) | (((bytes + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4))
+        == 0x3333333333333333ULL;
+}
+
+// value of eight digits loaded little-endian, neighbouring digits, pairs and
+// quads are combined with one multiply each
+inline uint64_t eightDigitsValue(uint64_t bytes) {
+    bytes = ((bytes & 0x0F0F0F0F0F0F0F0FULL) * 2561) >> 8;
+    bytes = ((bytes & 0x00FF00FF00FF00FFULL) * 6553601) >> 16;
+    return ((bytes & 0x0000FFFF0000FFFFULL) * 42949672960001ULL) >> 32;
+}
 
-        result.push_back(digitA - digitB);
+inline uint64_t loadEightBytes(const char* p) {
+    uint64_t bytes = 0;
+    if constexpr (std::endian::native == std::endian::little) {
+        std::memcpy(&bytes, p, sizeof(bytes));
+    }
+    else {
+        for (size_t i = 8; i-- > 0;) bytes = bytes << 8 | static_cast<unsigned char>(p[i]);
     }
+    return bytes;
+}
 
+// returns the first char in [first, last) that is not a decimal digit
+const char* skipDecimalDigits(const char* first, const char* last) {
+    while (last - first >= 8 && isEightDigits(loadEightBytes(first))) first += 8;
+    while (first != last && *first >= '0' && *first <= '9') ++first;
+    return first;
+}
 
-    while (!result.empty() && result.back() == 0) {
-        result.pop_back();
+// value of at most 19 validated digits
+inline uint64_t decimalChunkValue(const char* first, const char* last) {
+    uint64_t value = 0;
+    for (; last - first >= 8; first += 8) {
+        value = value * 100000000 + eightDigitsValue(loadEightBytes(first));
+    }
+    for (; first != last; ++first) {
+        value = value * 10 + static_cast<uint64_t>(*first - '0');
     }
+    return value;
+}
 
+// magnitude of validated digits, short inputs take one word multiply-add per
+// 19-digit chunk, long ones are split so that the low part is a power of two
+// chunks long and joined by a cached power of ten
+LimbVector parseDecimal(const char* first, const char* last) {
+    if (first == last) return LimbVector();
+    const size_t length = static_cast<size_t>(last - first);
+    const size_t chunks = (length + DECIMAL_CHUNK_DIGITS - 1) / DECIMAL_CHUNK_DIGITS;
+    LimbVector result;
+    if (chunks < BIGNUM_DECIMAL_THRESHOLD) {
+        // the first chunk takes the remainder
+        size_t chunk = length - (chunks - 1) * DECIMAL_CHUNK_DIGITS;
+        uint64_t scale = 1;
+        for (size_t i = 0; i < chunk; ++i) scale *= 10;
+        for (; first != last; first += chunk, chunk = DECIMAL_CHUNK_DIGITS, scale = DECIMAL_CHUNK_BASE) {
+            mulAddSmall(result, scale, decimalChunkValue(first, first + chunk));
+        }
+        return result;
+    }
 
-    if (result.empty()) {
-        return { 0 };
+    size_t low = 1, k = 0;
+    while (2 * low < chunks) {
+        low *= 2;
+        ++k;
     }
+    const char* middle = last - low * DECIMAL_CHUNK_DIGITS;
+    result = multiply(parseDecimal(first, middle), decimalPower(k));
+    addInPlace(result, parseDecimal(middle, last));
+    return result;
+}
 
-    std::reverse(result.begin(), result.end());
+const char* skipRadixDigits(const char* first, const char* last, int base) {
+    if (base == 10) return skipDecimalDigits(first, last);
+    while (first != last && radixDigitValue(*first) < base) ++first;
+    return first;
+}
 
+// magnitude of validated base digits, powers of two are packed as bit fields
+// from the last digit up, other bases take one word multiply-add per chunk
+LimbVector parseRadix(const char* first, const char* last, int base) {
+    if (base == 10) return parseDecimal(first, last);
+    if (std::has_single_bit(static_cast<unsigned>(base))) {
+        const size_t bits = static_cast<size_t>(std::countr_zero(static_cast<unsigned>(base)));
+        LimbVector result((static_cast<size_t>(last - first) * bits + 63) / 64, 0);
+        for (size_t bit = 0; last != first; bit += bits) {
+            const uint64_t value = static_cast<uint64_t>(radixDigitValue(*--last));
+            const size_t limb = bit / 64, shift = bit % 64;
+            result[limb] |= value << shift;
+            if (shift + bits > 64) result[limb + 1] |= value >> (64 - shift);
+        }
+        trimLimbs(result);
+        return result;
+    }
+
+    uint64_t power;
+    const size_t chunkDigits = radixChunkDigits(base, power);
+    LimbVector result;
+    // the first chunk takes the remainder
+    size_t chunk = static_cast<size_t>(last - first) % chunkDigits;
+    if (chunk == 0) chunk = chunkDigits;
+    for (; first != last; first += chunk, chunk = chunkDigits) {
+        uint64_t value = 0, scale = 1;
+        for (const char* p = first; p != first + chunk; ++p) {
+            value = value * static_cast<uint64_t>(base) + static_cast<uint64_t>(radixDigitValue(*p));
+            scale *= static_cast<uint64_t>(base);
+        }
+        mulAddSmall(result, scale, value);
+    }
+    return result;
+}
+
+// magnitude of count chunk words, most significant first, each holding
+// chunkDigits base digits and power = base^chunkDigits unless base is a power
+// of two: those words are bit fields laid end to end, decimal ones are joined
+// two halves at a time like parseDecimal, other bases take one multiply-add
+// per word
+LimbVector joinRadixChunks(const uint64_t* words, size_t count, int base, size_t chunkDigits, uint64_t power) {
+    if (std::has_single_bit(static_cast<unsigned>(base))) {
+        const size_t bits = chunkDigits * static_cast<size_t>(std::countr_zero(static_cast<unsigned>(base)));
+        LimbVector result((count * bits + 63) / 64, 0);
+        for (size_t i = count, bit = 0; i-- > 0; bit += bits) {
+            const size_t limb = bit / 64, shift = bit % 64;
+            result[limb] |= words[i] << shift;
+            if (shift + bits > 64) result[limb + 1] |= words[i] >> (64 - shift);
+        }
+        trimLimbs(result);
+        return result;
+    }
+
+    LimbVector result;
+    if (base != 10 || count < BIGNUM_DECIMAL_THRESHOLD) {
+        for (size_t i = 0; i < count; ++i) mulAddSmall(result, power, words[i]);
+        return result;
+    }
+    size_t low = 1, k = 0;
+    while (2 * low < count) {
+        low *= 2;
+        ++k;
+    }
+    result = multiply(joinRadixChunks(words, count - low, base, chunkDigits, power), decimalPower(k));
+    addInPlace(result, joinRadixChunks(words + count - low, low, base, chunkDigits, power));
     return result;
 }
 
+// r[0..an) = a[0..an) + b[0..bn) for an >= bn, returns the carry out
+// r may alias a or b as long as the limbs line up
+uint64_t addLimbs(uint64_t* r, const uint64_t* a, size_t an, const uint64_t* b, size_t bn) {
+    uint64_t carry = 0;
+    size_t i = 0;
+    for (; i < bn; ++i) {
+        uint64_t sum = a[i] + carry;
+        carry = sum < carry;
+        sum += b[i];
+        carry += sum < b[i];
+        r[i] = sum;
+    }
+    for (; i < an; ++i) {
+        r[i] = a[i] + carry;
+        carry = r[i] < carry;
+    }
+    return carry;
+}
+
+// r[0..an) = a[0..an) - b[0..bn) for an >= bn, returns the borrow out
+// r may alias a or b as long as the limbs line up
+uint64_t subLimbs(uint64_t* r, const uint64_t* a, size_t an, const uint64_t* b, size_t bn) {
+    uint64_t borrow = 0;
+    size_t i = 0;
+    for (; i < bn; ++i) {
+        uint64_t diff = a[i] - b[i];
+        uint64_t nextBorrow = (a[i] < b[i]) + (diff < borrow);
+        r[i] = diff - borrow;
+        borrow = nextBorrow;
+    }
+    for (; i < an; ++i) {
+        uint64_t limb = a[i];
+        r[i] = limb - borrow;
+        borrow = limb < borrow;
+    }
+    return borrow;
+}
 
-std::vector<int> naive_mul(const std::vector<int>& x, const std::vector<int>& y) {
+// r[0..n) += a[0..n) * m, returns the carry out
+uint64_t mulAddLimbs(uint64_t* r, const uint64_t* a, size_t n, uint64_t m) {
+    uint64_t carry = 0;
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t hi;
+        uint64_t lo = mulWide(a[i], m, hi);
+        lo += carry;
+        hi += lo < carry;
+        lo += r[i];
+        hi += lo < r[i];
+        r[i] = lo;
+        carry = hi;
+    }
+    return carry;
+}
 
+// r[0..n) -= a[0..n) * m, returns the borrow out
+uint64_t subMulLimbs(uint64_t* r, const uint64_t* a, size_t n, uint64_t m) {
+    uint64_t borrow = 0;
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t hi;
+        uint64_t lo = mulWide(a[i], m, hi);
+        lo += borrow;
+        hi += lo < borrow;
+        uint64_t limb = r[i];
+        r[i] = limb - lo;
+        hi += limb < lo;
+        borrow = hi;
+    }
+    return borrow;
+}
 
-    int tsize = static_cast<int>(x.size());
-    int bsize = static_cast<int>(y.size());
+void addInPlace(LimbVector& lhs, const LimbVector& rhs) {
+    if (lhs.size() < rhs.size()) lhs.resize(rhs.size(), 0);
+    // rhs may alias lhs, so its limbs are only read after the resize
+    uint64_t carry = addLimbs(lhs.data(), lhs.data(), lhs.size(), rhs.data(), rhs.size());
+    if (carry != 0) lhs.push_back(carry);
+}
 
-    std::vector<int> pos(static_cast<int>(tsize + bsize), 0);
-    for (int i = tsize - 1; i >= 0; i--) {
-        for (int j = bsize - 1; j >= 0; j--) {
-            int mul = (x[i]) * (y[j]);
-            int p1 = i + j, p2 = i + j + 1;
-            int sum = mul + pos[p2];
-            pos[p1] += sum / 10;
-            pos[p2] = sum % 10;
-        }
+// lhs = |lhs - rhs|
+void subtractInPlace(LimbVector& lhs, const LimbVector& rhs) {
+    if (compareMagnitude(lhs, rhs) >= 0) {
+        subLimbs(lhs.data(), lhs.data(), lhs.size(), rhs.data(), rhs.size());
+    }
+    else {
+        size_t size = lhs.size();
+        lhs.resize(rhs.size(), 0);
+        subLimbs(lhs.data(), rhs.data(), rhs.size(), lhs.data(), size);
+    }
+    trimLimbs(lhs);
+}
+
+LimbVector add(const LimbVector& lhs, const LimbVector& rhs) {
+    LimbVector result = lhs.size() >= rhs.size() ? lhs : rhs;
+    addInPlace(result, lhs.size() >= rhs.size() ? rhs : lhs);
+    return result;
+}
+
+// returns |lhs - rhs|
+LimbVector subtract(const LimbVector& lhs, const LimbVector& rhs) {
+    LimbVector result = lhs;
+    subtractInPlace(result, rhs);
+    return result;
+}
+
+// r[0..xn + yn) = x * y for zeroed r, r must not alias x or y
+void mulLimbs(uint64_t* r, const uint64_t* x, size_t xn, const uint64_t* y, size_t yn) {
+    for (size_t i = 0; i < xn; i++) {
+        r[i + yn] = mulAddLimbs(r + i, y, yn, x[i]);
+    }
+}
+
+// r[0..2n) = x * x for zeroed r, the products x[i] * x[j] for i < j are
+// summed once and doubled before the diagonal squares are added
+void sqrLimbs(uint64_t* r, const uint64_t* x, size_t n) {
+    for (size_t i = 0; i + 1 < n; i++) {
+        r[i + n] = mulAddLimbs(r + 2 * i + 1, x + i + 1, n - i - 1, x[i]);
+    }
+    uint64_t shifted = 0;
+    for (size_t i = 0; i < 2 * n; i++) {
+        uint64_t next = r[i] >> 63;
+        r[i] = (r[i] << 1) | shifted;
+        shifted = next;
+    }
+    uint64_t carry = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint64_t hi;
+        uint64_t lo = mulWide(x[i], x[i], hi);
+        uint64_t sum = r[2 * i] + carry;
+        carry = sum < carry;
+        sum += lo;
+        carry += sum < lo;
+        r[2 * i] = sum;
+        sum = r[2 * i + 1] + carry;
+        carry = sum < carry;
+        sum += hi;
+        carry += sum < hi;
+        r[2 * i + 1] = sum;
+    }
+}
+
+LimbVector naive_mul(const LimbVector& x, const LimbVector& y) {
+    if (x.empty() || y.empty()) return {};
+
+    // small products are formed on the stack so that a result that still
+    // fits inline never touches the heap
+    const size_t stackLimbs = 2 * LimbVector::INLINE_LIMBS;
+    uint64_t stackPos[stackLimbs] = {};
+    LimbVector heapPos;
+    uint64_t* pos = stackPos;
+    if (x.size() + y.size() > stackLimbs) {
+        heapPos.resize(x.size() + y.size(), 0);
+        pos = heapPos.data();
+    }
+    mulLimbs(pos, x.data(), x.size(), y.data(), y.size());
+
+    if (pos == stackPos) {
+        size_t used = x.size() + y.size();
+        while (used > 0 && stackPos[used - 1] == 0) --used;
+        return LimbVector(stackPos, stackPos + used);
+    }
+    trimLimbs(heapPos);
+    return heapPos;
+}
+
+// schoolbook squaring
+LimbVector naive_sqr(const LimbVector& x) {
+    if (x.empty()) return {};
+
+    const size_t stackLimbs = 2 * LimbVector::INLINE_LIMBS;
+    uint64_t stackPos[stackLimbs] = {};
+    LimbVector heapPos;
+    uint64_t* pos = stackPos;
+    size_t n = x.size();
+    if (2 * n > stackLimbs) {
+        heapPos.resize(2 * n, 0);
+        pos = heapPos.data();
     }
-    std::vector<int> res;
-    for (int p : pos) if (!(res.size() == 0 && p == 0)) res.push_back(p);
+    sqrLimbs(pos, x.data(), n);
 
-    //std::reverse(res.begin(), res.end());
-    return res;
+    if (pos == stackPos) {
+        size_t used = 2 * n;
+        while (used > 0 && stackPos[used - 1] == 0) --used;
+        return LimbVector(stackPos, stackPos + used);
+    }
+    trimLimbs(heapPos);
+    return heapPos;
+}
 
+// lhs = lhs * rhs in the buffer of lhs, rhs must not alias lhs
+void mulInPlace(LimbVector& lhs, const LimbVector& rhs) {
+    size_t size = lhs.size();
+    if (size + rhs.size() <= 2 * LimbVector::INLINE_LIMBS) {
+        LimbVector product = naive_mul(lhs, rhs);
+        lhs = product;
+        return;
+    }
+
+    lhs.resize(size + rhs.size(), 0);
+    uint64_t* r = lhs.data();
+    // walk from the top limb down, so every limb of lhs is read before
+    // partial products can reach its position
+    for (size_t i = size; i-- > 0;) {
+        uint64_t limb = r[i];
+        r[i] = 0;
+        uint64_t carry = mulAddLimbs(r + i, rhs.data(), rhs.size(), limb);
+        for (size_t k = i + rhs.size(); carry != 0; ++k) {
+            r[k] += carry;
+            carry = r[k] < carry;
+        }
+    }
+    trimLimbs(lhs);
 }
 
 
-std::vector<int> karatsuba_mul(const std::vector<int>& x, const std::vector<int>& y) {
+// result += part * 2^(64 * shift), result must be long enough to hold the sum
+void addShifted(LimbVector& result, const LimbVector& part, size_t shift) {
+    uint64_t* r = result.data() + shift;
+    uint64_t carry = addLimbs(r, r, part.size(), part.data(), part.size());
+    for (size_t i = shift + part.size(); carry != 0; ++i) {
+        result[i] += carry;
+        carry = result[i] < carry;
+    }
+}
+
+LimbVector karatsuba_mul(const LimbVector& x, const LimbVector& y) {
     auto len = x.size();
     if (len < y.size()) {
         return karatsuba_mul(y, x);
     }
     if (len == 0 || y.size() == 0) {
-        return std::vector<int>();
+        return LimbVector();
     }
-    if (len <= 32) {
+    if (y.size() < BIGNUM_KARATSUBA_THRESHOLD) {
         return naive_mul(x, y);
     }
 
     auto half = len / 2;
-    auto low1 = std::vector<int>(x.begin(), x.begin() + half);
-    auto high1 = std::vector<int>(x.begin() + half, x.end());
-    auto low2 = std::vector<int>(y.begin(), y.begin() + std::min(half, y.size()));
-    auto high2 = std::vector<int>(y.begin() + std::min(half, y.size()), y.end());
+    auto low1 = LimbVector(x.begin(), x.begin() + half);
+    auto high1 = LimbVector(x.begin() + half, x.end());
+    auto low2 = LimbVector(y.begin(), y.begin() + std::min(half, y.size()));
+    auto high2 = LimbVector(y.begin() + std::min(half, y.size()), y.end());
+    trimLimbs(low1);
+    trimLimbs(low2);
+
+    auto z0 = multiply(low1, low2);
+    auto z2 = multiply(high1, high2);
+    // z1 = (low1 + high1) * (low2 + high2) - z0 - z2 is never negative
+    auto z1 = multiply(add(low1, high1), add(low2, high2));
+    subtractInPlace(z1, z0);
+    subtractInPlace(z1, z2);
+
+    LimbVector result(x.size() + y.size(), 0);
+    addShifted(result, z0, 0);
+    addShifted(result, z1, half);
+    addShifted(result, z2, 2 * half);
+
+    trimLimbs(result);
+    return result;
+}
+
+LimbVector karatsuba_sqr(const LimbVector& x) {
+    if (x.size() < BIGNUM_KARATSUBA_SQR_THRESHOLD) {
+        return naive_sqr(x);
+    }
+
+    auto half = x.size() / 2;
+    auto low = LimbVector(x.begin(), x.begin() + half);
+    auto high = LimbVector(x.begin() + half, x.end());
+    trimLimbs(low);
+
+    auto z0 = square(low);
+    auto z2 = square(high);
+    // z1 = (low + high)^2 - z0 - z2 = 2 * low * high
+    auto z1 = square(add(low, high));
+    subtractInPlace(z1, z0);
+    subtractInPlace(z1, z2);
 
-    auto z0 = karatsuba_mul(low1, low2);
-    auto z1 = karatsuba_mul(add(low1, high1), add(low2, high2));
-    auto z2 = karatsuba_mul(high1, high2);
+    LimbVector result(2 * x.size(), 0);
+    addShifted(result, z0, 0);
+    addShifted(result, z1, half);
+    addShifted(result, z2, 2 * half);
 
-    // Resize z1 to accommodate subtraction
-    z1.resize(z2.size() + half, 0);
-    for (size_t i = 0; i < z2.size(); i++) {
-        z1[i + half] -= z2[i];
+    trimLimbs(result);
+    return result;
+}
+
+// Toom-3 with evaluation points 0, 1, -1, -2, infinity and Bodrato's
+// interpolation sequence, the signed intermediate values are BigIntegers
+LimbVector toom3_mul(const LimbVector& x, const LimbVector& y) {
+    size_t k = (std::max(x.size(), y.size()) + 2) / 3;
+    auto part = [k](const LimbVector& v, size_t index) {
+        size_t from = std::min(v.size(), index * k);
+        size_t to = std::min(v.size(), from + k);
+        BigInteger result;
+        setNumber(result, LimbVector(v.begin() + from, v.begin() + to));
+        return result;
+    };
+    BigInteger x0 = part(x, 0), x1 = part(x, 1), x2 = part(x, 2);
+    BigInteger y0 = part(y, 0), y1 = part(y, 1), y2 = part(y, 2);
+
+    BigInteger p = x0 + x2;
+    BigInteger p1 = p + x1;
+    BigInteger pm1 = p - x1;
+    BigInteger pm2 = (pm1 + x2) * BigInteger(2) - x0;
+    BigInteger q = y0 + y2;
+    BigInteger q1 = q + y1;
+    BigInteger qm1 = q - y1;
+    BigInteger qm2 = (qm1 + y2) * BigInteger(2) - y0;
+
+    BigInteger r0 = x0 * y0;
+    BigInteger r1 = p1 * q1;
+    BigInteger rm1 = pm1 * qm1;
+    BigInteger rm2 = pm2 * qm2;
+    BigInteger rinf = x2 * y2;
+
+    BigInteger c3 = (rm2 - r1) / BigInteger(3);
+    BigInteger c1 = (r1 - rm1) / BigInteger(2);
+    BigInteger c2 = rm1 - r0;
+    c3 = (c2 - c3) / BigInteger(2) + rinf * BigInteger(2);
+    c2 += c1;
+    c2 -= rinf;
+    c1 -= c3;
+
+    // every coefficient of the product polynomial is non-negative
+    LimbVector result(x.size() + y.size(), 0);
+    addShifted(result, getNumber(r0), 0);
+    addShifted(result, getNumber(c1), k);
+    addShifted(result, getNumber(c2), 2 * k);
+    addShifted(result, getNumber(c3), 3 * k);
+    addShifted(result, getNumber(rinf), 4 * k);
+
+    trimLimbs(result);
+    return result;
+}
+
+// three primes below 2^62 of the form c * 3 * 2^k + 1 with k >= 44, their
+// product exceeds n * 2^128 for any transform length n < 2^57, so whole
+// 64-bit limbs are convolved exactly and recovered by CRT
+constexpr uint64_t NTT_PRIMES[3] = { 0x3fffc00000000001ULL, 0x3ffd500000000001ULL, 0x3ffa500000000001ULL };
+constexpr uint64_t NTT_GENERATORS[3] = { 11, 5, 7 };
+
+inline uint64_t mulMod(uint64_t a, uint64_t b, uint64_t p) {
+    uint64_t hi, rem;
+    uint64_t lo = mulWide(a, b, hi);
+    divWide(hi, lo, p, rem);
+    return rem;
+}
+
+inline uint64_t powMod(uint64_t base, uint64_t exp, uint64_t p) {
+    uint64_t result = 1;
+    for (; exp != 0; exp >>= 1) {
+        if (exp & 1) result = mulMod(result, base, p);
+        base = mulMod(base, base, p);
     }
-    for (size_t i = 0; i < low1.size(); i++) {
-        z1[i] -= z0[i];
+    return result;
+}
+
+// a * b / 2^64 mod p for a * b < p * 2^64, p odd
+inline uint64_t montMul(uint64_t a, uint64_t b, uint64_t p, uint64_t pinv) {
+    uint64_t hi, mHi;
+    uint64_t lo = mulWide(a, b, hi);
+    mulWide(lo * pinv, p, mHi);
+    return hi >= mHi ? hi - mHi : hi - mHi + p;
+}
+
+// per prime Montgomery constants and root tables, the tables only ever
+// grow, so one table serves every transform size up to the largest seen
+struct NttPrime {
+    uint64_t p = 0;
+    uint64_t pinv = 0;        // p^-1 mod 2^64
+    uint64_t r2 = 0;          // 2^128 mod p
+    uint64_t generator = 0;
+    // roots[h + j] = w^j for the primitive 2h-th root of unity w, Montgomery
+    // form, roots[0] is unused
+    std::vector<uint64_t> roots{ 0 };
+    std::vector<uint64_t> inverseRoots{ 0 };
+    // radix-3 twiddles for length 3 * 2^k, indexed by k
+    std::vector<std::vector<uint64_t>> radix3Roots;
+    std::vector<std::vector<uint64_t>> radix3InverseRoots;
+
+    uint64_t toMontgomery(uint64_t a) const {
+        return montMul(a, r2, p, pinv);
+    }
+
+    // Montgomery form of g^((p - 1) / order), inverted if requested
+    uint64_t root(uint64_t order, bool inverse) const {
+        uint64_t exponent = (p - 1) / order;
+        return toMontgomery(powMod(generator, inverse ? p - 1 - exponent : exponent, p));
+    }
+
+    void fillPowers(std::vector<uint64_t>& table, size_t from, size_t count, uint64_t step) const {
+        uint64_t w = toMontgomery(1);
+        for (size_t j = 0; j < count; ++j) {
+            table[from + j] = w;
+            w = montMul(w, step, p, pinv);
+        }
     }
 
-    std::vector<int> result(len * 2);
-    for (size_t i = 0; i < z0.size(); i++) {
-        result[i] += z0[i];
+    void ensureRoots(size_t n) {
+        for (size_t half = roots.size(); half < n; half *= 2) {
+            roots.resize(2 * half);
+            inverseRoots.resize(2 * half);
+            fillPowers(roots, half, half, root(2 * half, false));
+            fillPowers(inverseRoots, half, half, root(2 * half, true));
+        }
     }
-    for (size_t i = half; i < z1.size() + half; i++) {
-        result[i] += z1[i - half];
+
+    const std::vector<uint64_t>& ensureRadix3Roots(size_t k, bool inverse) {
+        if (radix3Roots.size() <= k) {
+            radix3Roots.resize(k + 1);
+            radix3InverseRoots.resize(k + 1);
+        }
+        std::vector<uint64_t>& table = inverse ? radix3InverseRoots[k] : radix3Roots[k];
+        if (table.empty()) {
+            size_t m = size_t(1) << k;
+            table.resize(2 * m);
+            fillPowers(table, 0, 2 * m, root(3 * m, inverse));
+        }
+        return table;
     }
-    for (size_t i = 0; i < z2.size(); i++) {
-        result[i + len] += z2[i];
+};
+
+inline NttPrime& nttPrime(int index) {
+    thread_local NttPrime primes[3];
+    NttPrime& prime = primes[index];
+    if (prime.p == 0) {
+        uint64_t p = NTT_PRIMES[index];
+        uint64_t pinv = p;
+        for (int i = 0; i < 5; ++i) pinv *= 2 - p * pinv;
+        uint64_t r = (std::numeric_limits<uint64_t>::max() % p + 1) % p;
+        prime.p = p;
+        prime.pinv = pinv;
+        prime.r2 = mulMod(r, r, p);
+        prime.generator = NTT_GENERATORS[index];
+    }
+    return prime;
+}
+
+// decimation in frequency, natural order in, bit-reversed order out
+void nttForward(uint64_t* a, size_t n, const NttPrime& prime) {
+    const uint64_t p = prime.p, pinv = prime.pinv;
+    for (size_t half = n / 2; half >= 1; half /= 2) {
+        const uint64_t* w = prime.roots.data() + half;
+        for (size_t start = 0; start < n; start += 2 * half) {
+            uint64_t* x = a + start;
+            uint64_t* y = x + half;
+            for (size_t j = 0; j < half; ++j) {
+                uint64_t u = x[j], v = y[j];
+                uint64_t sum = u + v;
+                x[j] = sum >= p ? sum - p : sum;
+                y[j] = montMul(u >= v ? u - v : u + p - v, w[j], p, pinv);
+            }
+        }
     }
+}
+
+// decimation in time, bit-reversed order in, natural order out, not scaled
+void nttInverse(uint64_t* a, size_t n, const NttPrime& prime) {
+    const uint64_t p = prime.p, pinv = prime.pinv;
+    for (size_t half = 1; half < n; half *= 2) {
+        const uint64_t* w = prime.inverseRoots.data() + half;
+        for (size_t start = 0; start < n; start += 2 * half) {
+            uint64_t* x = a + start;
+            uint64_t* y = x + half;
+            for (size_t j = 0; j < half; ++j) {
+                uint64_t u = x[j], v = montMul(y[j], w[j], p, pinv);
+                uint64_t sum = u + v;
+                x[j] = sum >= p ? sum - p : sum;
+                y[j] = u >= v ? u - v : u + p - v;
+            }
+        }
+    }
+}
+
+// transforms of length 2^k or 3 * 2^k, the radix-3 step splits the input
+// into three power-of-two blocks whose spectra are kept side by side
+void nttTransform(uint64_t* a, size_t n, NttPrime& prime, bool inverse) {
+    size_t m = n;
+    if (n % 3 == 0) m = n / 3;
+    prime.ensureRoots(m);
+    if (m == n) {
+        inverse ? nttInverse(a, n, prime) : nttForward(a, n, prime);
+        return;
+    }
+
+    const uint64_t p = prime.p, pinv = prime.pinv;
+    size_t k = 0;
+    while ((size_t(1) << k) < m) ++k;
+    const std::vector<uint64_t>& twiddles = prime.ensureRadix3Roots(k, inverse);
+    // primitive cube root of unity, its inverse for the inverse transform,
+    // w3^2 = -1 - w3 leaves a single multiplication per triple either way
+    const uint64_t w3 = prime.root(3, inverse);
+    auto sub = [p](uint64_t u, uint64_t v) { return u >= v ? u - v : u + p - v; };
+    auto plus = [p](uint64_t u, uint64_t v) { return u + v >= p ? u + v - p : u + v; };
+
+    if (!inverse) {
+        for (size_t j = 0; j < m; ++j) {
+            uint64_t a0 = a[j], a1 = a[j + m], a2 = a[j + 2 * m];
+            uint64_t s = montMul(sub(a1, a2), w3, p, pinv);
+            a[j] = plus(plus(a0, a1), a2);
+            a[j + m] = montMul(plus(sub(a0, a2), s), twiddles[j], p, pinv);
+            a[j + 2 * m] = montMul(sub(sub(a0, a1), s), twiddles[2 * j], p, pinv);
+        }
+        for (int block = 0; block < 3; ++block) nttForward(a + block * m, m, prime);
+    }
+    else {
+        for (int block = 0; block < 3; ++block) nttInverse(a + block * m, m, prime);
+        for (size_t j = 0; j < m; ++j) {
+            uint64_t b0 = a[j];
+            uint64_t b1 = montMul(a[j + m], twiddles[j], p, pinv);
+            uint64_t b2 = montMul(a[j + 2 * m], twiddles[2 * j], p, pinv);
+            uint64_t s = montMul(sub(b1, b2), w3, p, pinv);
+            a[j] = plus(plus(b0, b1), b2);
+            a[j + m] = plus(sub(b0, b2), s);
+            a[j + 2 * m] = sub(sub(b0, b1), s);
+        }
+    }
+}
+
+// smallest transform length of the form 2^k or 3 * 2^k holding n coefficients
+size_t nttLength(size_t n) {
+    size_t power = 1;
+    while (power < n) power <<= 1;
+    size_t threeTimes = 3;
+    while (threeTimes < n) threeTimes <<= 1;
+    return std::min(power, threeTimes);
+}
+
+// convolution of x and y modulo one prime into fx, squares when x aliases y
+void nttConvolve(std::vector<uint64_t>& fx, const LimbVector& x, const LimbVector& y, size_t n, int index) {
+    NttPrime& prime = nttPrime(index);
+    const uint64_t p = prime.p, pinv = prime.pinv;
+    fx.assign(n, 0);
+    for (size_t i = 0; i < x.size(); ++i) fx[i] = x[i] % p;
+    nttTransform(fx.data(), n, prime, false);
+    if (&x == &y) {
+        for (size_t i = 0; i < n; ++i) fx[i] = montMul(fx[i], fx[i], p, pinv);
+    }
+    else {
+        std::vector<uint64_t> fy(n, 0);
+        for (size_t i = 0; i < y.size(); ++i) fy[i] = y[i] % p;
+        nttTransform(fy.data(), n, prime, false);
+        for (size_t i = 0; i < n; ++i) fx[i] = montMul(fx[i], fy[i], p, pinv);
+    }
+    nttTransform(fx.data(), n, prime, true);
+    // undo the 2^-64 of the pointwise product together with the 1/n scaling
+    uint64_t scale = prime.toMontgomery(prime.toMontgomery(powMod(n % p, p - 2, p)));
+    for (size_t i = 0; i < n; ++i) fx[i] = montMul(fx[i], scale, p, pinv);
+}
+
+LimbVector ntt_mul(const LimbVector& x, const LimbVector& y) {
+    if (x.empty() || y.empty()) return LimbVector();
+
+    size_t resultSize = x.size() + y.size();
+    size_t n = nttLength(resultSize - 1);
+
+    std::vector<uint64_t> residues[3];
+    for (int k = 0; k < 3; ++k) {
+        nttConvolve(residues[k], x, y, n, k);
+    }
+
+    // Garner: c = r0 + p0 * t1 + p0 * p1 * t2, all constants in Montgomery form
+    const NttPrime& prime1 = nttPrime(1);
+    const NttPrime& prime2 = nttPrime(2);
+    const uint64_t p0 = NTT_PRIMES[0], p1 = prime1.p, p2 = prime2.p;
+    const uint64_t inv01 = prime1.toMontgomery(powMod(p0 % p1, p1 - 2, p1));
+    const uint64_t inv012 = prime2.toMontgomery(powMod(mulMod(p0 % p2, p1 % p2, p2), p2 - 2, p2));
+    const uint64_t p0mod2 = prime2.toMontgomery(p0 % p2);
+    uint64_t p01hi;
+    const uint64_t p01lo = mulWide(p0, p1, p01hi);
+
+    LimbVector result(resultSize, 0);
+    uint64_t acc0 = 0, acc1 = 0, acc2 = 0;
+    for (size_t i = 0; i + 1 < resultSize; ++i) {
+        uint64_t r0 = residues[0][i], r1 = residues[1][i], r2 = residues[2][i];
+        // p0 < 2 * p1 and p0 < 2 * p2, so one subtraction reduces r0
+        uint64_t r0mod1 = r0 >= p1 ? r0 - p1 : r0;
+        uint64_t r0mod2 = r0 >= p2 ? r0 - p2 : r0;
+        uint64_t t1 = montMul(r1 >= r0mod1 ? r1 - r0mod1 : r1 + p1 - r0mod1, inv01, p1, prime1.pinv);
+        uint64_t x01mod2 = montMul(t1, p0mod2, p2, prime2.pinv) + r0mod2;
+        if (x01mod2 >= p2) x01mod2 -= p2;
+        uint64_t t2 = montMul(r2 >= x01mod2 ? r2 - x01mod2 : r2 + p2 - x01mod2, inv012, p2, prime2.pinv);
+
+        // (v2:v1:v0) = r0 + p0 * t1 + (p01hi:p01lo) * t2
+        uint64_t v1;
+        uint64_t v0 = mulWide(p0, t1, v1);
+        v0 += r0;
+        v1 += v0 < r0;
+        uint64_t lowHi, highHi;
+        uint64_t lowLo = mulWide(p01lo, t2, lowHi);
+        uint64_t highLo = mulWide(p01hi, t2, highHi);
+        v0 += lowLo;
+        uint64_t carry = v0 < lowLo;
+        v1 += carry;
+        uint64_t v2 = v1 < carry;
+        v1 += lowHi;
+        v2 += v1 < lowHi;
+        v1 += highLo;
+        v2 += v1 < highLo;
+        v2 += highHi;
+
+        acc0 += v0;
+        carry = acc0 < v0;
+        acc1 += carry;
+        acc2 += acc1 < carry;
+        acc1 += v1;
+        acc2 += acc1 < v1;
+        acc2 += v2;
+
+        result[i] = acc0;
+        acc0 = acc1;
+        acc1 = acc2;
+        acc2 = 0;
+    }
+    result[resultSize - 1] = acc0;
+
+    trimLimbs(result);
     return result;
 }
 
+// picks the multiplication kernel by operand size
+LimbVector multiply(const LimbVector& x, const LimbVector& y) {
+    if (x == y) {
+        return square(x);
+    }
+    const LimbVector& a = x.size() >= y.size() ? x : y;
+    const LimbVector& b = x.size() >= y.size() ? y : x;
+    if (b.size() < BIGNUM_KARATSUBA_THRESHOLD) {
+        return naive_mul(a, b);
+    }
+
+    // unbalanced operands: multiply the longer one in chunks of the shorter length
+    if (a.size() >= 2 * b.size()) {
+        LimbVector result(a.size() + b.size(), 0);
+        for (size_t offset = 0; offset < a.size(); offset += b.size()) {
+            LimbVector chunk(a.begin() + offset, a.begin() + std::min(a.size(), offset + b.size()));
+            trimLimbs(chunk);
+            addShifted(result, multiply(chunk, b), offset);
+        }
+        trimLimbs(result);
+        return result;
+    }
+
+    if (b.size() < BIGNUM_TOOM3_THRESHOLD) {
+        return karatsuba_mul(a, b);
+    }
+    if (b.size() < BIGNUM_NTT_THRESHOLD) {
+        return toom3_mul(a, b);
+    }
+    return ntt_mul(a, b);
+}
+
+// picks the squaring kernel by operand size, Toom-3 and the NTT square when
+// both operands are the same
+LimbVector square(const LimbVector& x) {
+    if (x.size() < BIGNUM_TOOM3_SQR_THRESHOLD) {
+        return karatsuba_sqr(x);
+    }
+    if (x.size() < BIGNUM_NTT_THRESHOLD) {
+        return toom3_mul(x, x);
+    }
+    return ntt_mul(x, x);
+}
+
+// Knuth's Algorithm D (TAOCP 4.3.1) on 64-bit limbs for lhs >= rhs and a
+// divisor of two or more limbs, the divisor is shifted so that its top bit
+// is set, which keeps every quotient estimate at most two above the true
+// quotient limb
+void divideKnuth(const LimbVector& lhs, const LimbVector& rhs,
+    LimbVector& quotient, LimbVector& remainder) {
+    const size_t n = rhs.size();
+    const size_t m = lhs.size() - n;
+    const int shift = std::countl_zero(rhs.back());
+
+    // v = rhs << shift, u = lhs << shift with one extra top limb, both on
+    // the stack while they are small enough for inline results
+    const size_t stackLimbs = 2 * LimbVector::INLINE_LIMBS;
+    uint64_t stackU[stackLimbs] = {}, stackV[stackLimbs] = {};
+    LimbVector heapU, heapV;
+    uint64_t* u = stackU;
+    uint64_t* v = stackV;
+    if (lhs.size() + 1 > stackLimbs) {
+        heapU.resize(lhs.size() + 1, 0);
+        heapV.resize(n, 0);
+        u = heapU.data();
+        v = heapV.data();
+    }
+    for (size_t i = n; i-- > 0;) {
+        v[i] = rhs[i] << shift;
+        if (shift != 0 && i > 0) v[i] |= rhs[i - 1] >> (64 - shift);
+    }
+    for (size_t i = lhs.size(); i-- > 0;) {
+        u[i] = lhs[i] << shift;
+        if (shift != 0) u[i + 1] |= lhs[i] >> (64 - shift);
+    }
+
+    const uint64_t top = v[n - 1], second = v[n - 2];
+    quotient.assign(m + 1, 0);
+    for (size_t j = m + 1; j-- > 0;) {
+        // estimate the quotient limb from the top two limbs of the running
+        // remainder, the invariant u[j + n] <= top holds
+        uint64_t qhat, rhat;
+        bool rhatOverflow = false;
+        if (u[j + n] == top) {
+            qhat = std::numeric_limits<uint64_t>::max();
+            rhat = u[j + n - 1] + top;
+            rhatOverflow = rhat < top;
+        }
+        else {
+            qhat = divWide(u[j + n], u[j + n - 1], top, rhat);
+        }
+        // refine with the second divisor limb, corrects all but rare off-by-one cases
+        while (!rhatOverflow) {
+            uint64_t hi;
+            uint64_t lo = mulWide(qhat, second, hi);
+            if (hi < rhat || (hi == rhat && lo <= u[j + n - 2])) break;
+            --qhat;
+            rhat += top;
+            rhatOverflow = rhat < top;
+        }
+
+        uint64_t borrow = subMulLimbs(u + j, v, n, qhat);
+        uint64_t limb = u[j + n];
+        u[j + n] = limb - borrow;
+        if (limb < borrow) {
+            // the estimate was one too large, add the divisor back
+            --qhat;
+            u[j + n] += addLimbs(u + j, u + j, n, v, n);
+        }
+        quotient[j] = qhat;
+    }
+    trimLimbs(quotient);
+
+    // the remainder is the low n limbs of u shifted back
+    remainder.assign(n, 0);
+    for (size_t i = 0; i < n; ++i) {
+        remainder[i] = u[i] >> shift;
+        if (shift != 0) remainder[i] |= u[i + 1] << (64 - shift);
+    }
+    trimLimbs(remainder);
+}
+
+// x << shift for 0 <= shift < 64
+LimbVector shiftLeftBits(const LimbVector& x, int shift) {
+    LimbVector result(x.size() + 1, 0);
+    for (size_t i = x.size(); i-- > 0;) {
+        result[i] = x[i] << shift;
+        if (shift != 0) result[i + 1] |= x[i] >> (64 - shift);
+    }
+    trimLimbs(result);
+    return result;
+}
+
+// x >> shift for 0 <= shift < 64
+LimbVector shiftRightBits(const LimbVector& x, int shift) {
+    LimbVector result(x.size(), 0);
+    for (size_t i = 0; i < x.size(); ++i) {
+        result[i] = x[i] >> shift;
+        if (shift != 0 && i + 1 < x.size()) result[i] |= x[i + 1] << (64 - shift);
+    }
+    trimLimbs(result);
+    return result;
+}
+
+// x / 2^(64 * count)
+LimbVector highLimbs(const LimbVector& x, size_t count) {
+    if (x.size() <= count) return LimbVector();
+    return LimbVector(x.begin() + count, x.end());
+}
+
+// x mod 2^(64 * count)
+LimbVector lowLimbs(const LimbVector& x, size_t count) {
+    LimbVector result(x.begin(), x.begin() + std::min(count, x.size()));
+    trimLimbs(result);
+    return result;
+}
+
+// high * 2^(64 * count) + low for low below 2^(64 * count)
+LimbVector joinLimbs(const LimbVector& high, const LimbVector& low, size_t count) {
+    if (high.empty()) return low;
+    LimbVector result(count + high.size(), 0);
+    std::copy(low.begin(), low.end(), result.begin());
+    std::copy(high.begin(), high.end(), result.begin() + count);
+    return result;
+}
+
+// normalises the divisor and walks lhs from the top in blocks of
+// rhs.size() limbs, each step hands a value below b * 2^(64 * b.size())
+// and the normalised divisor b to divideBlock
+void divideByBlocks(const LimbVector& lhs, const LimbVector& rhs,
+    LimbVector& quotient, LimbVector& remainder,
+    const std::function<void(const LimbVector&, const LimbVector&, LimbVector&, LimbVector&)>& divideBlock) {
+    const int shift = std::countl_zero(rhs.back());
+    const LimbVector b = shiftLeftBits(rhs, shift);
+    const LimbVector a = shiftLeftBits(lhs, shift);
+    const size_t n = b.size();
+    const size_t blocks = (a.size() + n - 1) / n;
+
+    quotient.assign(blocks * n, 0);
+    remainder.clear();
+    for (size_t i = blocks; i-- > 0;) {
+        LimbVector block(a.begin() + i * n, a.begin() + std::min(a.size(), (i + 1) * n));
+        trimLimbs(block);
+        LimbVector blockQuotient;
+        divideBlock(joinLimbs(remainder, block, n), b, blockQuotient, remainder);
+        std::copy(blockQuotient.begin(), blockQuotient.end(), quotient.begin() + i * n);
+    }
+    trimLimbs(quotient);
+    remainder = shiftRightBits(remainder, shift);
+}
+
+// Burnikel and Ziegler's 3n / 2n step in half limbs of b: a12 * 2^(64 * half) + a3
+// divided by b = b1 * 2^(64 * half) + b2, b1 estimates the quotient
+void divideThreeByTwo(const LimbVector& a12, const LimbVector& a3, const LimbVector& b,
+    const LimbVector& b1, const LimbVector& b2, LimbVector& quotient, LimbVector& remainder) {
+    const size_t half = b1.size();
+    if (highLimbs(a12, half) == b1) {
+        // the estimate would overflow half limbs, 2^(64 * half) - 1 is at most two too large
+        quotient.assign(half, std::numeric_limits<uint64_t>::max());
+        remainder = subtract(a12, joinLimbs(b1, LimbVector(), half));
+        addInPlace(remainder, b1);
+    }
+    else {
+        divideTwoByOne(a12, b1, quotient, remainder);
+    }
+
+    LimbVector rest = joinLimbs(remainder, a3, half);
+    LimbVector product = multiply(quotient, b2);
+    while (compareMagnitude(rest, product) < 0) {
+        subtractInPlace(quotient, LimbVector{ 1 });
+        addInPlace(rest, b);
+    }
+    subtractInPlace(rest, product);
+    remainder = std::move(rest);
+}
+
+// Burnikel and Ziegler's recursive 2n / n division for a < b * 2^(64 * n) and
+// a normalised b of n limbs, the halves are divided with fast multiplication
+void divideTwoByOne(const LimbVector& a, const LimbVector& b, LimbVector& quotient, LimbVector& remainder) {
+    const size_t n = b.size();
+    if (n < BIGNUM_BZ_THRESHOLD) {
+        divideMagnitude(a, b, quotient, remainder);
+        return;
+    }
+    if (n % 2 != 0) {
+        // one zero limb below both operands evens out the halves
+        divideTwoByOne(joinLimbs(a, LimbVector(), 1), joinLimbs(b, LimbVector(), 1), quotient, remainder);
+        remainder = highLimbs(remainder, 1);
+        return;
+    }
+
+    const size_t half = n / 2;
+    const LimbVector b1 = highLimbs(b, half);
+    const LimbVector b2 = lowLimbs(b, half);
+    LimbVector high, low, rest;
+    divideThreeByTwo(highLimbs(a, n), lowLimbs(highLimbs(a, half), half), b, b1, b2, high, rest);
+    divideThreeByTwo(rest, lowLimbs(a, half), b, b1, b2, low, remainder);
+    quotient = joinLimbs(high, low, half);
+}
+
+// floor((2^(128 * n) - 1) / b) for a normalised b of n limbs, one Newton step
+// x + x * (2^(128 * n) - 1 - b * x) / 2^(128 * n) from the reciprocal of the
+// top half doubles the precision, the last few units are fixed exactly
+LimbVector reciprocal(const LimbVector& b) {
+    const size_t n = b.size();
+    LimbVector allOnes(2 * n, std::numeric_limits<uint64_t>::max());
+    if (n < BIGNUM_NEWTON_THRESHOLD) {
+        LimbVector quotient, remainder;
+        divideMagnitude(allOnes, b, quotient, remainder);
+        return quotient;
+    }
+
+    // x = y * 2^(64 * (n - h)) has about h correct limbs, the error
+    // 2^(128 * n) - 1 - b * x is then about 2^(64 * (2 * n - h))
+    const size_t h = (n + 1) / 2;
+    BigInteger y, divisor, error;
+    setNumber(y, reciprocal(highLimbs(b, n - h)));
+    setNumber(divisor, b);
+    setNumber(error, allOnes);
+    BigInteger scaled;
+    setNumber(scaled, joinLimbs(getNumber(divisor * y), LimbVector(), n - h));
+    error -= scaled;
+
+    // x * error / 2^(128 * n) = y * error / 2^(64 * (n + h)), the low n - 1
+    // limbs of the error change the correction by less than one
+    BigInteger errorHigh, step, delta;
+    setNumber(errorHigh, highLimbs(getNumber(error), n - 1));
+    setSign(errorHigh, getSign(error));
+    step = y * errorHigh;
+    setNumber(delta, highLimbs(getNumber(step), h + 1));
+    setSign(delta, getSign(step));
+
+    BigInteger x;
+    setNumber(x, joinLimbs(getNumber(y), LimbVector(), n - h));
+    x += delta;
+    BigInteger remainder = error - divisor * delta;
+    while (getSign(remainder) < 0) {
+        x -= BigInteger(1);
+        remainder += divisor;
+    }
+    while (remainder >= divisor) {
+        x += BigInteger(1);
+        remainder -= divisor;
+    }
+    return getNumber(x);
+}
+
+// picks the division algorithm by divisor and quotient size
+void divideMagnitude(const LimbVector& lhs, const LimbVector& rhs,
+    LimbVector& quotient, LimbVector& remainder) {
+    if (compareMagnitude(lhs, rhs) < 0) {
+        quotient.clear();
+        remainder = lhs;
+        return;
+    }
+    if (rhs.size() == 1) {
+        quotient = lhs;
+        uint64_t rem = divSmall(quotient, rhs[0]);
+        remainder.clear();
+        if (rem != 0) remainder.push_back(rem);
+        return;
+    }
+    if (rhs.size() < BIGNUM_BZ_THRESHOLD || lhs.size() - rhs.size() < BIGNUM_BZ_THRESHOLD) {
+        divideKnuth(lhs, rhs, quotient, remainder);
+        return;
+    }
+    // a Newton reciprocal only pays off once it is shared by several blocks
+    if (rhs.size() < BIGNUM_NEWTON_THRESHOLD || lhs.size() < 4 * rhs.size()) {
+        divideByBlocks(lhs, rhs, quotient, remainder, divideTwoByOne);
+        return;
+    }
+
+    // every block estimates its quotient from the reciprocal of the
+    // normalised divisor, at most three below the true quotient
+    LimbVector inverse;
+    divideByBlocks(lhs, rhs, quotient, remainder,
+        [&inverse](const LimbVector& a, const LimbVector& b, LimbVector& blockQuotient, LimbVector& blockRemainder) {
+            if (inverse.empty()) inverse = reciprocal(b);
+            // the top n + 1 limbs of a are enough for the estimate
+            const size_t n = b.size();
+            blockQuotient = highLimbs(multiply(highLimbs(a, n - 1), inverse), n + 1);
+            blockRemainder = subtract(a, multiply(blockQuotient, b));
+            while (compareMagnitude(blockRemainder, b) >= 0) {
+                subtractInPlace(blockRemainder, b);
+                addInPlace(blockQuotient, LimbVector{ 1 });
+            }
+        });
+}
+
+// s * x + t * y for word cofactors of opposite signs (one may be zero),
+// the caller knows that the combination is not negative
+LimbVector combineLimbs(const LimbVector& x, int64_t s, const LimbVector& y, int64_t t) {
+    if (t > 0) return combineLimbs(y, t, x, s);
+
+    LimbVector result(std::max(x.size(), y.size()) + 1, 0);
+    result[x.size()] = mulAddLimbs(result.data(), x.data(), x.size(), static_cast<uint64_t>(s));
+    uint64_t borrow = subMulLimbs(result.data(), y.data(), y.size(), static_cast<uint64_t>(-t));
+    for (size_t k = y.size(); borrow != 0; ++k) {
+        uint64_t limb = result[k];
+        result[k] = limb - borrow;
+        borrow = limb < borrow;
+    }
+    trimLimbs(result);
+    return result;
+}
+
+// the leading Euclid steps of a >= b > 0 as single-word cofactors, Lehmer's
+// inner loop (TAOCP 4.5.2, Algorithm L) on the leading 62 bits keeps only the
+// quotients that provably match those of the full values: the reduced pair is
+// (A * a + B * b, C * a + D * b), and B == 0 when no step could be taken
+void lehmerCofactors(const LimbVector& a, const LimbVector& b, int64_t& A, int64_t& B, int64_t& C, int64_t& D) {
+    A = 1;
+    B = 0;
+    C = 0;
+    D = 1;
+    if (a.size() != b.size() || a.size() < 2) return;
+
+    const size_t n = a.size();
+    const int shift = std::countl_zero(a[n - 1]);
+    auto leading = [n, shift](const LimbVector& v) {
+        uint64_t top = v[n - 1] << shift;
+        if (shift != 0) top |= v[n - 2] >> (64 - shift);
+        return static_cast<int64_t>(top >> 2);
+    };
+    int64_t x = leading(a), y = leading(b);
+    while (y + C != 0 && y + D != 0) {
+        int64_t q = (x + A) / (y + C);
+        if (q != (x + B) / (y + D)) break;
+        int64_t t = A - q * C;
+        A = C;
+        C = t;
+        t = B - q * D;
+        B = D;
+        D = t;
+        t = x - q * y;
+        x = y;
+        y = t;
+    }
+}
+
+// s * x + t * y for word factors
+LimbVector addProducts(const LimbVector& x, uint64_t s, const LimbVector& y, uint64_t t) {
+    LimbVector result(std::max(x.size(), y.size()) + 2, 0);
+    result[x.size()] = mulAddLimbs(result.data(), x.data(), x.size(), s);
+    uint64_t carry = mulAddLimbs(result.data(), y.data(), y.size(), t);
+    for (size_t k = y.size(); carry != 0; ++k) {
+        result[k] += carry;
+        carry = result[k] < carry;
+    }
+    trimLimbs(result);
+    return result;
+}
+
+// (a, b) = M * (alpha, beta) for a product M of Euclid quotient matrices
+// [[q, 1], [1, 0]], so no entry is negative and m11 is the largest one
+struct EuclidMatrix {
+    LimbVector m11{ 1 }, m12, m21, m22{ 1 };
+    int determinant = 1;
+
+    bool isIdentity() const {
+        return m12.empty() && m21.empty();
+    }
+
+    // M = M * other
+    void append(const EuclidMatrix& other) {
+        LimbVector n11 = multiply(m11, other.m11);
+        addInPlace(n11, multiply(m12, other.m21));
+        LimbVector n12 = multiply(m11, other.m12);
+        addInPlace(n12, multiply(m12, other.m22));
+        LimbVector n21 = multiply(m21, other.m11);
+        addInPlace(n21, multiply(m22, other.m21));
+        LimbVector n22 = multiply(m21, other.m12);
+        addInPlace(n22, multiply(m22, other.m22));
+        m11 = std::move(n11);
+        m12 = std::move(n12);
+        m21 = std::move(n21);
+        m22 = std::move(n22);
+        determinant *= other.determinant;
+    }
+
+    // M = M * [[p11, p12], [p21, p22]] for a quotient matrix with word entries,
+    // top is the new m11 when the caller has it already
+    void append(uint64_t p11, uint64_t p12, uint64_t p21, uint64_t p22, int sign, LimbVector top) {
+        LimbVector n12 = addProducts(m11, p12, m12, p22);
+        LimbVector n21 = addProducts(m21, p11, m22, p21);
+        m22 = addProducts(m21, p12, m22, p22);
+        m11 = std::move(top);
+        m12 = std::move(n12);
+        m21 = std::move(n21);
+        determinant *= sign;
+    }
+
+    // M = M * [[q, 1], [1, 0]]
+    void push(const LimbVector& q) {
+        LimbVector top = multiply(m11, q);
+        addInPlace(top, m12);
+        push(q, std::move(top));
+    }
+
+    void push(const LimbVector& q, LimbVector top) {
+        m12 = std::move(m11);
+        m11 = std::move(top);
+        LimbVector bottom = multiply(m21, q);
+        addInPlace(bottom, m22);
+        m22 = std::move(m21);
+        m21 = std::move(bottom);
+        determinant = -determinant;
+    }
+
+    // (alpha, beta) = M^-1 * (a, b) where M^-1 took the limbs of a and b from
+    // position p up to (alphaHigh, betaHigh), so only their low limbs are left
+    void reduce(const LimbVector& a, const LimbVector& b, size_t p,
+        const LimbVector& alphaHigh, const LimbVector& betaHigh, LimbVector& alpha, LimbVector& beta) const {
+        const LimbVector aLow = lowLimbs(a, p), bLow = lowLimbs(b, p);
+        alpha = completeReduced(alphaHigh, p, m22, aLow, m12, bLow, determinant);
+        beta = completeReduced(betaHigh, p, m11, bLow, m21, aLow, determinant);
+    }
+
+private:
+    // high * 2^(64 * p) + sign * (s * x - t * y), the caller knows it is not negative
+    static LimbVector completeReduced(const LimbVector& high, size_t p,
+        const LimbVector& s, const LimbVector& x, const LimbVector& t, const LimbVector& y, int sign) {
+        LimbVector low = multiply(s, x);
+        const LimbVector other = multiply(t, y);
+        const bool negative = (compareMagnitude(low, other) < 0) == (sign > 0);
+        subtractInPlace(low, other);
+        LimbVector result = joinLimbs(high, LimbVector(), p);
+        if (negative) subtractInPlace(result, low);
+        else addInPlace(result, low);
+        return result;
+    }
+};
+
+// the half gcd keeps a matrix only while the pair it leaves stays at least
+// 2 * m11 and more than 4 * m11 apart: values that differ from the pair by
+// less than m11 in every limb below position p then still leave a pair in
+// order, so the quotients found on the leading limbs hold for the whole values
+bool halfGcdKeeps(const LimbVector& alpha, const LimbVector& beta, const LimbVector& largest) {
+    const LimbVector twice = add(largest, largest);
+    if (compareMagnitude(beta, twice) < 0 || compareMagnitude(alpha, beta) <= 0) return false;
+    return compareMagnitude(subtract(alpha, beta), add(twice, twice)) > 0;
+}
+
+// Euclid steps on (alpha, beta) folded into matrix as long as halfGcdKeeps
+// allows, Lehmer batches while they stay inside and single divisions after,
+// the new m11 decides before the rest of the matrix is formed
+void halfGcdSteps(EuclidMatrix& matrix, LimbVector& alpha, LimbVector& beta) {
+    auto magnitude = [](int64_t v) {
+        return v < 0 ? 0 - static_cast<uint64_t>(v) : static_cast<uint64_t>(v);
+    };
+    LimbVector quotient, remainder;
+    bool batches = true;
+    while (!beta.empty()) {
+        int64_t A = 1, B = 0, C = 0, D = 1;
+        if (batches) lehmerCofactors(alpha, beta, A, B, C, D);
+        if (batches && B != 0) {
+            // the inverse of the cofactor matrix is the quotient matrix of the batch
+            LimbVector nextAlpha = combineLimbs(alpha, A, beta, B);
+            LimbVector nextBeta = combineLimbs(alpha, C, beta, D);
+            LimbVector top = addProducts(matrix.m11, magnitude(D), matrix.m12, magnitude(C));
+            if (halfGcdKeeps(nextAlpha, nextBeta, top)) {
+                matrix.append(magnitude(D), magnitude(B), magnitude(C), magnitude(A), D > 0 ? 1 : -1, std::move(top));
+                alpha = std::move(nextAlpha);
+                beta = std::move(nextBeta);
+                continue;
+            }
+            batches = false;
+        }
+
+        divideMagnitude(alpha, beta, quotient, remainder);
+        LimbVector top = multiply(matrix.m11, quotient);
+        addInPlace(top, matrix.m12);
+        if (!halfGcdKeeps(beta, remainder, top)) break;
+        matrix.push(quotient, std::move(top));
+        alpha = std::move(beta);
+        beta = std::move(remainder);
+    }
+}
+
+void halfGcd(const LimbVector& a, const LimbVector& b, EuclidMatrix& matrix, LimbVector& alpha, LimbVector& beta);
+
+// reduces (alpha, beta) by the half gcd of their limbs from position p up
+void halfGcdLeading(EuclidMatrix& matrix, LimbVector& alpha, LimbVector& beta, size_t p) {
+    const LimbVector highAlpha = highLimbs(alpha, p), highBeta = highLimbs(beta, p);
+    if (compareMagnitude(highAlpha, highBeta) <= 0) return;
+    EuclidMatrix step;
+    LimbVector reducedAlpha, reducedBeta;
+    halfGcd(highAlpha, highBeta, step, reducedAlpha, reducedBeta);
+    if (step.isIdentity()) return;
+    step.reduce(alpha, beta, p, reducedAlpha, reducedBeta, alpha, beta);
+    matrix.append(step);
+}
+
+// Schonhage's half gcd for a > b: the quotient matrix and the pair it leaves,
+// about half as long as a, the top half of the limbs gives the first quarter
+// of the reduction, the top of what is left the second one
+void halfGcd(const LimbVector& a, const LimbVector& b, EuclidMatrix& matrix, LimbVector& alpha, LimbVector& beta) {
+    matrix = EuclidMatrix();
+    alpha = a;
+    beta = b;
+    if (a.size() >= BIGNUM_HGCD_THRESHOLD) {
+        halfGcdLeading(matrix, alpha, beta, a.size() / 2);
+        // shifted past the entries of the first matrix, the second one cannot
+        // take the pair further than halfGcdKeeps allows for the whole product
+        if (!matrix.isIdentity()) halfGcdLeading(matrix, alpha, beta, matrix.m11.size() + 1);
+    }
+    halfGcdSteps(matrix, alpha, beta);
+}
+
+// binary gcd of the double words (aHi:aLo) and (bHi:bLo) into (hi:lo), the
+// larger odd value takes the difference until both fit into one word and
+// gcd64 finishes, no limb vectors are touched
+void gcd128(uint64_t aHi, uint64_t aLo, uint64_t bHi, uint64_t bLo, uint64_t& hi, uint64_t& lo) {
+    auto trailingZeros = [](uint64_t high, uint64_t low) {
+        return low != 0 ? std::countr_zero(low) : 64 + std::countr_zero(high);
+    };
+    auto shiftRight = [](uint64_t& high, uint64_t& low, int count) {
+        if (count >= 64) {
+            low = high >> (count - 64);
+            high = 0;
+        }
+        else if (count != 0) {
+            low = (low >> count) | (high << (64 - count));
+            high >>= count;
+        }
+    };
+    if ((aHi | aLo) == 0 || (bHi | bLo) == 0) {
+        hi = aHi | bHi;
+        lo = aLo | bLo;
+        return;
+    }
+
+    const int shift = std::min(trailingZeros(aHi, aLo), trailingZeros(bHi, bLo));
+    shiftRight(aHi, aLo, trailingZeros(aHi, aLo));
+    shiftRight(bHi, bLo, trailingZeros(bHi, bLo));
+    while ((aHi | bHi) != 0 && (aHi != bHi || aLo != bLo)) {
+        if (aHi < bHi || (aHi == bHi && aLo < bLo)) {
+            std::swap(aHi, bHi);
+            std::swap(aLo, bLo);
+        }
+        aHi -= bHi + (aLo < bLo);
+        aLo -= bLo;
+        shiftRight(aHi, aLo, trailingZeros(aHi, aLo));
+    }
+    hi = aHi;
+    lo = aHi == 0 ? gcd64(aLo, bLo) : aLo;
+
+    // the common power of two goes back on, the result is no larger than the inputs
+    if (shift >= 64) {
+        hi = lo << (shift - 64);
+        lo = 0;
+    }
+    else if (shift != 0) {
+        hi = (hi << shift) | (lo >> (64 - shift));
+        lo <<= shift;
+    }
+}
+
+// gcd of a >= b, the half gcd takes long operands down to half their length
+// and Lehmer's batches take over below BIGNUM_HGCD_THRESHOLD, with cofactors
+// set the pair (s, t) with a = s * a0 + ... and b = t * a0 + ... for the
+// initial a0 is kept up to date
+LimbVector gcdLimbs(LimbVector a, LimbVector b, BigInteger* cofactors) {
+    // double words stay inline through the binary gcd
+    if (!cofactors && a.size() <= 2 && !b.empty()) {
+        uint64_t hi, lo;
+        gcd128(a.size() > 1 ? a[1] : 0, a[0], b.size() > 1 ? b[1] : 0, b[0], hi, lo);
+        LimbVector result{ lo, hi };
+        trimLimbs(result);
+        return result;
+    }
+    auto toBigInteger = [](const LimbVector& v) {
+        BigInteger result;
+        setNumber(result, v);
+        return result;
+    };
+    LimbVector quotient, remainder;
+    auto divisionStep = [&]() {
+        divideMagnitude(a, b, quotient, remainder);
+        std::swap(a, b);
+        std::swap(b, remainder);
+        if (cofactors) {
+            BigInteger next = cofactors[0] - toBigInteger(quotient) * cofactors[1];
+            cofactors[0] = std::move(cofactors[1]);
+            cofactors[1] = std::move(next);
+        }
+    };
+
+    while (b.size() > 1) {
+        if (b.size() >= BIGNUM_HGCD_THRESHOLD && a.size() - b.size() <= 1 && compareMagnitude(a, b) > 0) {
+            EuclidMatrix matrix;
+            LimbVector alpha, beta;
+            halfGcd(a, b, matrix, alpha, beta);
+            if (!matrix.isIdentity()) {
+                if (cofactors) {
+                    BigInteger s = toBigInteger(matrix.m22) * cofactors[0] - toBigInteger(matrix.m12) * cofactors[1];
+                    BigInteger t = toBigInteger(matrix.m11) * cofactors[1] - toBigInteger(matrix.m21) * cofactors[0];
+                    cofactors[0] = matrix.determinant > 0 ? s : -s;
+                    cofactors[1] = matrix.determinant > 0 ? t : -t;
+                }
+                a = std::move(alpha);
+                b = std::move(beta);
+                continue;
+            }
+        }
+
+        int64_t A, B, C, D;
+        lehmerCofactors(a, b, A, B, C, D);
+        if (B == 0) {
+            divisionStep();
+            continue;
+        }
+        if (cofactors) {
+            BigInteger s = BigInteger(A) * cofactors[0] + BigInteger(B) * cofactors[1];
+            cofactors[1] = BigInteger(C) * cofactors[0] + BigInteger(D) * cofactors[1];
+            cofactors[0] = std::move(s);
+        }
+        LimbVector nextA = combineLimbs(a, A, b, B);
+        b = combineLimbs(a, C, b, D);
+        a = std::move(nextA);
+    }
+
+    if (cofactors) {
+        while (!b.empty()) divisionStep();
+        return a;
+    }
+    // the rest fits into words, the binary gcd finishes it
+    if (b.empty()) return a;
+    uint64_t rest = 0;
+    for (size_t i = a.size(); i-- > 0;) {
+        divWide(rest, a[i], b[0], rest);
+    }
+    uint64_t result = gcd64(b[0], rest);
+    return LimbVector{ result };
+}
+
+LimbVector gcdMagnitude(LimbVector a, LimbVector b) {
+    if (compareMagnitude(a, b) < 0) std::swap(a, b);
+    return gcdLimbs(std::move(a), std::move(b), nullptr);
+}
+
 
 int getSign(const BigInteger& bigInt) {
     return bigInt.sign;
 }
 
 void setSign(BigInteger& bigInt, int sign) {
-    bigInt.sign = sign;
+    // zero is always stored with a positive sign
+    bigInt.sign = bigInt.number.empty() ? 1 : sign;
 }
 
 
-void setNumber(BigInteger& bigInt, const std::vector<int>& num) {
+void setNumber(BigInteger& bigInt, const LimbVector& num) {
     bigInt.number = num;
+    trimLimbs(bigInt.number);
+    if (bigInt.number.empty()) bigInt.sign = 1;
 }
 
-const std::vector<int>& getNumber(const BigInteger& bigInt) {
+const LimbVector& getNumber(const BigInteger& bigInt) {
     return bigInt.number;
 }
 
@@ -879,7 +2875,7 @@ const BigInteger& getDenominator(const BigRational& br) {
 }
 
 void setDenominator(BigRational& br, const BigInteger& bi) {
-    br.numerator = bi;
+    br.denominator = bi;
 }
 
 BigRational createBigRational(const BigInteger& a, const BigInteger& b) {
@@ -893,29 +2889,58 @@ BigRational createBigRational(const BigInteger& a, const BigInteger& b) {
 }
 
 BigInteger gcd(const BigInteger& a, const BigInteger& b) {
-    if (b == BigInteger(0)) {
-        return a;
-    }
-    else {
-        return gcd(b, a % b);
-    }
+    BigInteger result;
+    setNumber(result, gcdMagnitude(getNumber(a), getNumber(b)));
+    return result;
 }
 
+// g = gcd(a, b) with Bezout cofactors a * x + b * y = g, only the cofactor of
+// the longer operand is tracked through the reduction, the other one follows
+// from an exact division
+BigInteger extendedGcd(const BigInteger& a, const BigInteger& b, BigInteger& x, BigInteger& y) {
+    const bool swapped = compareMagnitude(getNumber(a), getNumber(b)) < 0;
+    const BigInteger& u = swapped ? b : a;
+    const BigInteger& v = swapped ? a : b;
+    BigInteger cofactors[2] = { BigInteger(1), BigInteger(0) };
+    BigInteger g;
+    setNumber(g, gcdLimbs(getNumber(u), getNumber(v), cofactors));
+
+    BigInteger s = cofactors[0];
+    setSign(s, getSign(s) * getSign(u));
+    BigInteger t = getNumber(v).empty() ? BigInteger(0) : (g - s * u) / v;
+    x = swapped ? t : s;
+    y = swapped ? s : t;
+    return g;
+}
+
+// binary gcd, shifts and subtractions only, both operands stay odd and the
+// smaller one and the difference are picked by masks: a compare and swap
+// would mispredict about every other step
 uint64_t gcd64(const uint64_t& a, const uint64_t& b) {
-    if (b == 0) {
-        return a;
-    }
-    else {
-        return gcd64(b, a % b);
-    }
+    if (a == 0) return b;
+    if (b == 0) return a;
+    const int shift = std::countr_zero(a | b);
+    uint64_t x = a >> std::countr_zero(a);
+    uint64_t y = b >> std::countr_zero(b);
+    while (x != y) {
+        const uint64_t diff = y - x;
+        const uint64_t mask = 0 - static_cast<uint64_t>(y < x);
+        x += diff & mask;
+        y = (diff ^ mask) - mask;
+        y >>= std::countr_zero(y);
+    }
+    return x << shift;
 }
 
 void normalizeInner(BigInteger& numerator, BigInteger& denominator) {
     int sign = getSign(numerator) * getSign(denominator);
     BigInteger d = gcd(numerator, denominator);
-    numerator = numerator / d;
+    // coprime terms are common, they need no exact division
+    if (d != BigInteger(1)) {
+        numerator /= d;
+        denominator /= d;
+    }
     setSign(numerator, sign);
-    denominator = denominator / d;
     setSign(denominator, 1);
 }
 
@@ -942,11 +2967,665 @@ BigRational normalize(const BigRational& br) {
     }
 
     BigInteger d = gcd(numerator, denominator);
-
-    numerator = numerator / d;
+    if (d != BigInteger(1)) {
+        numerator /= d;
+        denominator /= d;
+    }
     setSign(numerator, sign);
-    denominator = denominator / d;
     setSign(denominator, 1);
     return createBigRational(numerator, denominator);
 }
 
+
+// running sum of BigRationals without a gcd per term: a term is added to the
+// numerator when it shares the current denominator and cross-multiplied in
+// otherwise, the pair is reduced once the denominator grows past the limit
+// and whenever the value is read
+class BigRationalAccumulator {
+public:
+    explicit BigRationalAccumulator(size_t reduceLimbs = BIGNUM_ACCUMULATOR_LIMBS)
+        : limit(std::max<size_t>(reduceLimbs, 1)), reduceAt(limit) {
+    }
+
+    BigRationalAccumulator& operator+=(const BigRational& term) {
+        add(getNumerator(term), getDenominator(term));
+        return *this;
+    }
+
+    BigRationalAccumulator& operator-=(const BigRational& term) {
+        add(-getNumerator(term), getDenominator(term));
+        return *this;
+    }
+
+    // the sum so far in lowest terms
+    BigRational value() {
+        normalize();
+        return createBigRational(numerator, denominator);
+    }
+
+    void normalize() {
+        normalizeInner(numerator, denominator);
+        // a sum that is still long in lowest terms waits until it has doubled
+        reduceAt = std::max(limit, 2 * getNumber(denominator).size());
+    }
+
+private:
+    BigInteger numerator = BigInteger(0);
+    BigInteger denominator = BigInteger(1);
+    size_t limit;
+    size_t reduceAt;
+
+    void add(const BigInteger& n, const BigInteger& d) {
+        if (d == denominator) {
+            numerator += n;
+        }
+        else if (d == BigInteger(1)) {
+            numerator += n * denominator;
+        }
+        else {
+            numerator = numerator * d + n * denominator;
+            denominator *= d;
+        }
+        if (getNumber(denominator).size() > reduceAt) normalize();
+    }
+};
+
+
+// reduction by one fixed positive modulus, the divisor work is done once
+// when the object is built: reduce and mulmod use a Barrett reciprocal and
+// cost about two multiplications, powmod stays in Montgomery form for odd
+// moduli; the work space is kept per thread between calls, so one modulus
+// can be shared by threads like any other const object
+class BigModulus {
+public:
+    explicit BigModulus(const BigInteger& modulus) : value(modulus) {
+        if (getSign(modulus) < 0 || getNumber(modulus).empty()) {
+            throw std::runtime_error("invalid argument - non-positive modulus.");
+        }
+        const LimbVector& m = getNumber(modulus);
+        size = m.size();
+
+        // one division gives both mu = floor(R^2 / m) and R^2 mod m, R = 2^(64 * size)
+        LimbVector power(2 * size + 1, 0);
+        power.back() = 1;
+        divideMagnitude(power, m, mu, montgomerySquare);
+
+        if (size == 1) {
+            // reciprocal floor((2^128 - 1) / d) - 2^64 of the normalised word
+            wordShift = std::countl_zero(m[0]);
+            wordDivisor = m[0] << wordShift;
+            uint64_t rem;
+            wordReciprocal = divWide(~wordDivisor, std::numeric_limits<uint64_t>::max(), wordDivisor, rem);
+        }
+        if (m[0] & 1) {
+            // m^-1 mod 2^64 by Newton iteration, each step doubles the correct low bits
+            uint64_t inverse = m[0];
+            for (int i = 0; i < 5; ++i) inverse *= 2 - m[0] * inverse;
+            montgomeryFactor = ~inverse + 1;
+            montgomery = true;
+        }
+    }
+
+    const BigInteger& modulus() const {
+        return value;
+    }
+
+    // x mod m in [0, m), negative values included
+    BigInteger reduce(const BigInteger& x) const {
+        BigInteger result;
+        reduceMagnitude(getNumber(x), result.number);
+        if (getSign(x) < 0 && !result.number.empty()) {
+            subtractInPlace(result.number, getNumber(value));
+        }
+        return result;
+    }
+
+    // a * b mod m by Barrett for odd moduli too: leaving Montgomery form
+    // would take a second reduction and a multiplication by R^2 mod m
+    BigInteger mulmod(const BigInteger& a, const BigInteger& b) const {
+        Scratch& buffers = scratch();
+        const LimbVector& x = reducedOperand(a, buffers.left);
+        const LimbVector& y = reducedOperand(b, buffers.right);
+        BigInteger result;
+        productInto(x, y, buffers.product);
+        reduceMagnitude(buffers.product, result.number);
+        return result;
+    }
+
+    // x^-1 mod m from the Bezout cofactor of x, throws unless gcd(x, m) = 1
+    BigInteger inverse(const BigInteger& x) const {
+        BigInteger s, t;
+        if (extendedGcd(reduce(x), value, s, t) != BigInteger(1)) {
+            throw std::runtime_error("invalid argument - value is not invertible.");
+        }
+        return reduce(s);
+    }
+
+    // base^exponent mod m, left to right square and multiply
+    BigInteger powmod(const BigInteger& base, const BigInteger& exponent) const {
+        if (getSign(exponent) < 0) {
+            throw std::runtime_error("invalid argument - negative exponent.");
+        }
+        const LimbVector& e = getNumber(exponent);
+        Scratch& buffers = scratch();
+        const LimbVector& x = reducedOperand(base, buffers.left);
+        LimbVector& right = buffers.right;
+        LimbVector& product = buffers.product;
+        BigInteger power;
+        LimbVector& result = power.number;
+        if (montgomery) {
+            // b * R mod m, and R mod m as the Montgomery form of one
+            productInto(x, montgomerySquare, right);
+            montgomeryReduce(right);
+            result = montgomerySquare;
+            montgomeryReduce(result);
+            for (size_t i = e.size() * 64; i-- > 0;) {
+                squareInto(result, product);
+                montgomeryReduce(product);
+                std::swap(result, product);
+                if ((e[i / 64] >> (i % 64)) & 1) {
+                    productInto(result, right, product);
+                    montgomeryReduce(product);
+                    std::swap(result, product);
+                }
+            }
+            montgomeryReduce(result);
+        }
+        else {
+            right = x;
+            reduceMagnitude(LimbVector{ 1 }, result);
+            for (size_t i = e.size() * 64; i-- > 0;) {
+                squareInto(result, product);
+                barrettReduce(product.data(), product.size(), result);
+                if ((e[i / 64] >> (i % 64)) & 1) {
+                    productInto(result, right, product);
+                    barrettReduce(product.data(), product.size(), result);
+                }
+            }
+        }
+        return power;
+    }
+
+private:
+    BigInteger value;
+    size_t size = 0;
+    LimbVector mu;
+    LimbVector montgomerySquare;
+    uint64_t montgomeryFactor = 0; // -m^-1 mod 2^64
+    bool montgomery = false;
+    uint64_t wordDivisor = 0;
+    uint64_t wordReciprocal = 0;
+    int wordShift = 0;
+
+    // work space reused by every call on the same thread: reduced operands,
+    // their product, the Barrett estimate and a long input folded in one block
+    // at a time; no member function of one modulus calls into another, so
+    // the buffers are never in use twice
+    struct Scratch {
+        LimbVector left;
+        LimbVector right;
+        LimbVector product;
+        LimbVector work;
+        LimbVector folded;
+    };
+
+    static Scratch& scratch() {
+        thread_local Scratch buffers;
+        return buffers;
+    }
+
+    // |x| in [0, m) for a signed operand, in buffer unless it is already there
+    const LimbVector& reducedOperand(const BigInteger& x, LimbVector& buffer) const {
+        const LimbVector& m = getNumber(value);
+        if (getSign(x) > 0 && compareMagnitude(getNumber(x), m) < 0) return getNumber(x);
+        reduceMagnitude(getNumber(x), buffer);
+        if (getSign(x) < 0 && !buffer.empty()) subtractInPlace(buffer, m);
+        return buffer;
+    }
+
+    // out = x * y through the schoolbook kernel while it leads, out must not
+    // alias x or y
+    static void productInto(const LimbVector& x, const LimbVector& y, LimbVector& out) {
+        if (x.empty() || y.empty()) {
+            out.clear();
+        }
+        else if (std::min(x.size(), y.size()) < BIGNUM_KARATSUBA_THRESHOLD) {
+            out.assign(x.size() + y.size(), 0);
+            mulLimbs(out.data(), x.data(), x.size(), y.data(), y.size());
+            trimLimbs(out);
+        }
+        else {
+            out = multiply(x, y);
+        }
+    }
+
+    static void squareInto(const LimbVector& x, LimbVector& out) {
+        if (x.empty()) {
+            out.clear();
+        }
+        else if (x.size() < BIGNUM_KARATSUBA_SQR_THRESHOLD) {
+            out.assign(2 * x.size(), 0);
+            sqrLimbs(out.data(), x.data(), x.size());
+            trimLimbs(out);
+        }
+        else {
+            out = square(x);
+        }
+    }
+
+    // (hi:lo) mod wordDivisor for hi < wordDivisor, Moller and Granlund's
+    // division by an invariant word with a multiplication instead of a division
+    uint64_t reduceWord(uint64_t hi, uint64_t lo) const {
+        uint64_t qhi;
+        uint64_t qlo = mulWide(wordReciprocal, hi, qhi);
+        qlo += lo;
+        qhi += hi + (qlo < lo) + 1;
+        uint64_t rest = lo - qhi * wordDivisor;
+        if (rest > qlo) rest += wordDivisor;
+        if (rest >= wordDivisor) rest -= wordDivisor;
+        return rest;
+    }
+
+    // x[0..xn) mod m into out for x < 2^(128 * size), the quotient estimate
+    // from the top limbs is at most three below the true quotient, so the
+    // remainder is below 4 * m and its low size + 1 limbs determine it
+    void barrettReduce(const uint64_t* x, size_t xn, LimbVector& out) const {
+        const LimbVector& m = getNumber(value);
+        if (size >= BIGNUM_TOOM3_THRESHOLD && size < BIGNUM_NTT_THRESHOLD) {
+            // two full Toom-3 products cost as much as a Burnikel-Ziegler
+            // division, which needs no correction steps
+            LimbVector dividend(x, x + xn);
+            trimLimbs(dividend);
+            divideMagnitude(dividend, m, scratch().work, out);
+            return;
+        }
+        LimbVector& work = scratch().work;
+        const size_t highSize = xn > size - 1 ? xn - (size - 1) : 0;
+        const uint64_t* high = highSize != 0 ? x + (size - 1) : x;
+        work.assign(highSize + mu.size() + size + 1, 0);
+        uint64_t* estimate = work.data();
+        uint64_t* lowProduct = estimate + highSize + mu.size();
+        if (size < BIGNUM_TOOM3_THRESHOLD) {
+            // schoolbook short products do half the work of a full product,
+            // which keeps them ahead of Karatsuba up to the Toom-3 range, the
+            // partial products below limb size - 1 of the estimate only lower
+            // it by less than one
+            for (size_t i = 0; i < highSize; ++i) {
+                size_t from = i < size - 1 ? size - 1 - i : 0;
+                if (from >= mu.size()) continue;
+                estimate[i + mu.size()] = mulAddLimbs(estimate + i + from, mu.data() + from, mu.size() - from, high[i]);
+            }
+            const uint64_t* quotient = estimate + size + 1;
+            const size_t quotientSize = highSize + mu.size() > size + 1 ? highSize + mu.size() - (size + 1) : 0;
+            for (size_t i = 0; i < quotientSize && i <= size; ++i) {
+                size_t count = std::min(size, size + 1 - i);
+                uint64_t carry = mulAddLimbs(lowProduct + i, m.data(), count, quotient[i]);
+                if (i + count <= size) lowProduct[i + count] = carry;
+            }
+        }
+        else {
+            LimbVector quotient = highLimbs(multiply(LimbVector(high, high + highSize), mu), size + 1);
+            LimbVector full = multiply(quotient, m);
+            std::copy(full.begin(), full.begin() + std::min(full.size(), size + 1), lowProduct);
+        }
+
+        // x - quotient * m modulo 2^(64 * (size + 1))
+        out.assign(size + 1, 0);
+        std::copy(x, x + std::min(xn, size + 1), out.data());
+        subLimbs(out.data(), out.data(), size + 1, lowProduct, size + 1);
+        trimLimbs(out);
+        while (compareMagnitude(out, m) >= 0) {
+            subtractInPlace(out, m);
+        }
+    }
+
+    // |x| mod m into out, longer values are folded in from the top in blocks
+    // of size limbs so that every Barrett step stays below m * 2^(64 * size)
+    void reduceMagnitude(const LimbVector& x, LimbVector& out) const {
+        if (compareMagnitude(x, getNumber(value)) < 0) {
+            out = x;
+            return;
+        }
+        if (size == 1) {
+            // x << wordShift streamed limb by limb from the top
+            uint64_t rest = wordShift == 0 ? 0 : x.back() >> (64 - wordShift);
+            for (size_t i = x.size(); i-- > 0;) {
+                uint64_t limb = x[i] << wordShift;
+                if (wordShift != 0 && i > 0) limb |= x[i - 1] >> (64 - wordShift);
+                rest = reduceWord(rest, limb);
+            }
+            rest >>= wordShift;
+            out.clear();
+            if (rest != 0) out.push_back(rest);
+            return;
+        }
+        if (x.size() <= 2 * size) {
+            barrettReduce(x.data(), x.size(), out);
+            return;
+        }
+
+        out.clear();
+        LimbVector& folded = scratch().folded;
+        const size_t blocks = (x.size() + size - 1) / size;
+        for (size_t i = blocks; i-- > 0;) {
+            const size_t from = i * size, to = std::min(x.size(), from + size);
+            folded.assign(size + out.size(), 0);
+            std::copy(x.begin() + from, x.begin() + to, folded.data());
+            std::copy(out.begin(), out.end(), folded.data() + size);
+            barrettReduce(folded.data(), folded.size(), out);
+        }
+    }
+
+    // t / R mod m in place for t < m * R, every step clears the lowest remaining limb
+    void montgomeryReduce(LimbVector& t) const {
+        const LimbVector& m = getNumber(value);
+        t.resize(2 * size + 1, 0);
+        uint64_t* r = t.data();
+        for (size_t i = 0; i < size; ++i) {
+            uint64_t carry = mulAddLimbs(r + i, m.data(), size, r[i] * montgomeryFactor);
+            for (size_t k = i + size; carry != 0; ++k) {
+                r[k] += carry;
+                carry = r[k] < carry;
+            }
+        }
+        std::copy(r + size, r + 2 * size + 1, r);
+        t.resize(size + 1);
+        trimLimbs(t);
+        if (compareMagnitude(t, m) >= 0) subtractInPlace(t, m);
+    }
+};
+
+// binary format, every field little-endian:
+//   header   "BGN", version, kind (1 BigInteger, 2 BigRational),
+//            shape (1 one value, 2 array), two zero bytes
+//   array    uint64 count, then count values
+//   integer  uint64 limb count * 2 + 1 if negative, then the limbs
+//   rational numerator, then denominator, in lowest terms
+//   store    the limbs of every BigInteger back to back, then count + 1
+//            words limb offset * 2 + 1 if negative, then the count
+const unsigned char BINARY_VERSION = 1;
+const unsigned char BINARY_INTEGER = 1;
+const unsigned char BINARY_RATIONAL = 2;
+const unsigned char BINARY_ONE = 1;
+const unsigned char BINARY_ARRAY = 2;
+const unsigned char BINARY_STORE = 3;
+
+// swaps a word between native and little-endian order, both ways
+inline uint64_t littleEndianWord(uint64_t x) {
+    if constexpr (std::endian::native == std::endian::big) {
+        uint64_t result = 0;
+        for (int i = 0; i < 8; ++i, x >>= 8) result = result << 8 | (x & 0xff);
+        return result;
+    }
+    return x;
+}
+
+inline void writeBinaryWords(std::ostream& out, const uint64_t* words, size_t count) {
+    if constexpr (std::endian::native == std::endian::little) {
+        out.write(reinterpret_cast<const char*>(words), static_cast<std::streamsize>(count * sizeof(uint64_t)));
+    }
+    else {
+        for (size_t i = 0; i < count; ++i) {
+            uint64_t word = littleEndianWord(words[i]);
+            out.write(reinterpret_cast<const char*>(&word), sizeof(word));
+        }
+    }
+}
+
+// reads count words straight into words, grown a block at a time so that a
+// corrupt length runs into the end of the data before it is allocated
+inline bool readBinaryWords(std::istream& in, LimbVector& words, uint64_t count) {
+    const size_t block = size_t(1) << 20;
+    words.clear();
+    while (words.size() < count) {
+        size_t done = words.size();
+        size_t next = static_cast<size_t>(std::min<uint64_t>(count, done + block));
+        words.resize(next);
+        if (!in.read(reinterpret_cast<char*>(words.data() + done), static_cast<std::streamsize>((next - done) * sizeof(uint64_t)))) {
+            return false;
+        }
+    }
+    if constexpr (std::endian::native == std::endian::big) {
+        for (uint64_t& word : words) word = littleEndianWord(word);
+    }
+    return true;
+}
+
+inline void writeBinaryHeader(std::ostream& out, unsigned char kind, unsigned char shape) {
+    const char header[8] = { 'B', 'G', 'N', static_cast<char>(BINARY_VERSION), static_cast<char>(kind), static_cast<char>(shape), 0, 0 };
+    out.write(header, sizeof(header));
+}
+
+inline bool readBinaryHeader(std::istream& in, unsigned char kind, unsigned char shape) {
+    char header[8];
+    if (!in.read(header, sizeof(header))) return false;
+    const char expected[8] = { 'B', 'G', 'N', static_cast<char>(BINARY_VERSION), static_cast<char>(kind), static_cast<char>(shape), 0, 0 };
+    return std::equal(header, header + sizeof(header), expected);
+}
+
+inline void writeBinaryValue(std::ostream& out, const BigInteger& value) {
+    const LimbVector& limbs = getNumber(value);
+    uint64_t length = littleEndianWord(limbs.size() * 2 + (getSign(value) < 0 ? 1 : 0));
+    writeBinaryWords(out, &length, 1);
+    writeBinaryWords(out, limbs.data(), limbs.size());
+}
+
+// one value without a header, the limbs are read into a buffer that is
+// moved into value once they check out: short or non canonical data sets
+// failbit and leaves value alone, as the text extractors do
+inline std::istream& readBinaryValue(std::istream& in, BigInteger& value) {
+    uint64_t length = 0;
+    LimbVector limbs;
+    bool valid = static_cast<bool>(in.read(reinterpret_cast<char*>(&length), sizeof(length)));
+    length = littleEndianWord(length);
+    valid = valid && readBinaryWords(in, limbs, length / 2)
+        && (limbs.empty() ? (length & 1) == 0 : limbs.back() != 0);
+    if (!valid) {
+        in.setstate(std::ios::failbit);
+        return in;
+    }
+    value.number = std::move(limbs);
+    value.sign = (length & 1) != 0 ? -1 : 1;
+    return in;
+}
+
+inline void writeBinaryValue(std::ostream& out, const BigRational& value) {
+    writeBinaryValue(out, getNumerator(value));
+    writeBinaryValue(out, getDenominator(value));
+}
+
+// one value without a header, the terms are trusted to be coprime as they
+// were written, only the denominator is checked to be positive
+inline std::istream& readBinaryValue(std::istream& in, BigRational& value) {
+    BigInteger numerator, denominator;
+    if (readBinaryValue(in, numerator) && readBinaryValue(in, denominator)) {
+        const LimbVector& limbs = getNumber(denominator);
+        bool canonical = getSign(denominator) > 0 && !limbs.empty()
+            && (!getNumber(numerator).empty() || (limbs.size() == 1 && limbs[0] == 1));
+        if (canonical) {
+            value.numerator = std::move(numerator);
+            value.denominator = std::move(denominator);
+            return in;
+        }
+        in.setstate(std::ios::failbit);
+    }
+    return in;
+}
+
+inline unsigned char binaryKind(const BigInteger&) {
+    return BINARY_INTEGER;
+}
+
+inline unsigned char binaryKind(const BigRational&) {
+    return BINARY_RATIONAL;
+}
+
+// a header and one BigInteger or BigRational
+template <typename T>
+std::ostream& writeBinary(std::ostream& out, const T& value) {
+    writeBinaryHeader(out, binaryKind(value), BINARY_ONE);
+    writeBinaryValue(out, value);
+    return out;
+}
+
+template <typename T>
+std::istream& readBinary(std::istream& in, T& value) {
+    if (!readBinaryHeader(in, binaryKind(value), BINARY_ONE)) {
+        in.setstate(std::ios::failbit);
+        return in;
+    }
+    return readBinaryValue(in, value);
+}
+
+// a header, the count and the values of a contiguous array
+template <typename T>
+std::ostream& writeBinary(std::ostream& out, const std::vector<T>& values) {
+    writeBinaryHeader(out, binaryKind(T()), BINARY_ARRAY);
+    uint64_t count = littleEndianWord(values.size());
+    writeBinaryWords(out, &count, 1);
+    for (const T& value : values) writeBinaryValue(out, value);
+    return out;
+}
+
+// values are read at the back of a fresh vector that replaces values only
+// when the whole array came through, the count is not trusted with the
+// first reserve for the same reason as the limb count
+template <typename T>
+std::istream& readBinary(std::istream& in, std::vector<T>& values) {
+    uint64_t count = 0;
+    if (!readBinaryHeader(in, binaryKind(T()), BINARY_ARRAY) || !in.read(reinterpret_cast<char*>(&count), sizeof(count))) {
+        in.setstate(std::ios::failbit);
+        return in;
+    }
+    count = littleEndianWord(count);
+    std::vector<T> result;
+    result.reserve(static_cast<size_t>(std::min<uint64_t>(count, uint64_t(1) << 16)));
+    for (uint64_t i = 0; i < count; ++i) {
+        result.emplace_back();
+        if (!readBinaryValue(in, result.back())) return in;
+    }
+    values.swap(result);
+    return in;
+}
+
+// read-only BigInteger over limbs that live elsewhere, mapped from a store
+// or borrowed from a BigInteger that outlives the view, a temporary would
+// leave it dangling, so views of BigIntegers are taken explicitly and never
+// of rvalues
+class BigIntegerView {
+public:
+    BigIntegerView(const uint64_t* first, size_t length, int valueSign) : limbs(first), count(length), sign(length == 0 ? 1 : valueSign) {
+    }
+
+    explicit BigIntegerView(const BigInteger& value) : limbs(value.number.data()), count(value.number.size()), sign(value.sign) {
+    }
+
+    BigIntegerView(BigInteger&&) = delete;
+
+    const uint64_t* data() const {
+        return limbs;
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    int getSign() const {
+        return sign;
+    }
+
+    BigInteger toBigInteger() const {
+        return make(LimbVector(limbs, limbs + count), sign);
+    }
+
+    // signed sum of the views straight from their limbs
+    static BigInteger sum(BigIntegerView lhs, BigIntegerView rhs) {
+        int cmp = compareLimbs(lhs.limbs, lhs.count, rhs.limbs, rhs.count);
+        const BigIntegerView& big = cmp >= 0 ? lhs : rhs;
+        const BigIntegerView& small = cmp >= 0 ? rhs : lhs;
+        LimbVector result(big.count + 1, 0);
+        if (lhs.sign == rhs.sign) {
+            result[big.count] = addLimbs(result.data(), big.limbs, big.count, small.limbs, small.count);
+        }
+        else {
+            subLimbs(result.data(), big.limbs, big.count, small.limbs, small.count);
+        }
+        trimLimbs(result);
+        return make(std::move(result), big.sign);
+    }
+
+    // schoolbook on the mapped limbs while the shorter operand is below the
+    // Karatsuba cut-off, the faster kernels split copies of their operands
+    static BigInteger product(BigIntegerView lhs, BigIntegerView rhs) {
+        const BigIntegerView& a = lhs.count >= rhs.count ? lhs : rhs;
+        const BigIntegerView& b = lhs.count >= rhs.count ? rhs : lhs;
+        if (b.count == 0) return BigInteger();
+        if (b.count >= BIGNUM_KARATSUBA_THRESHOLD) {
+            return make(::multiply(LimbVector(a.limbs, a.limbs + a.count), LimbVector(b.limbs, b.limbs + b.count)), a.sign * b.sign);
+        }
+        LimbVector result(a.count + b.count, 0);
+        for (size_t i = 0; i < b.count; ++i) {
+            result[i + a.count] = mulAddLimbs(result.data() + i, a.limbs, a.count, b.limbs[i]);
+        }
+        trimLimbs(result);
+        return make(std::move(result), a.sign * b.sign);
+    }
+
+private:
+    const uint64_t* limbs;
+    size_t count;
+    int sign;
+
+    static BigInteger make(LimbVector&& number, int valueSign) {
+        BigInteger result;
+        result.number = std::move(number);
+        result.sign = result.number.empty() ? 1 : valueSign;
+        return result;
+    }
+};
+
+inline int compare(BigIntegerView lhs, BigIntegerView rhs) {
+    if (lhs.getSign() != rhs.getSign()) return lhs.getSign() < rhs.getSign() ? -1 : 1;
+    int cmp = compareLimbs(lhs.data(), lhs.size(), rhs.data(), rhs.size());
+    return lhs.getSign() > 0 ? cmp : -cmp;
+}
+
+inline bool operator==(BigIntegerView lhs, BigIntegerView rhs) {
+    return compare(lhs, rhs) == 0;
+}
+
+inline bool operator!=(BigIntegerView lhs, BigIntegerView rhs) {
+    return compare(lhs, rhs) != 0;
+}
+
+inline bool operator<(BigIntegerView lhs, BigIntegerView rhs) {
+    return compare(lhs, rhs) < 0;
+}
+
+inline bool operator>(BigIntegerView lhs, BigIntegerView rhs) {
+    return compare(lhs, rhs) > 0;
+}
+
+inline bool operator<=(BigIntegerView lhs, BigIntegerView rhs) {
+    return compare(lhs, rhs) <= 0;
+}
+
+inline bool operator>=(BigIntegerView lhs, BigIntegerView rhs) {
+    return compare(lhs, rhs) >= 0;
+}
+
+inline BigInteger operator+(BigIntegerView lhs, BigIntegerView rhs) {
+    return BigIntegerView::sum(lhs, rhs);
+}
+
+inline BigInteger operator-(BigIntegerView lhs, BigIntegerView rhs) {
+    return BigIntegerView::sum(lhs, BigIntegerView(rhs.data(), rhs.size(), -rhs.getSign()));
+}
+
+inline BigInteger operator*(BigIntegerView lhs, BigIntegerView rhs) {
+    return BigIntegerView::product(lhs, rhs);
+}
+
+inline std::ostream& operator<<(std::ostream& lhs, BigIntegerView rhs) {
+    return lhs << rhs.toBigInteger();
+}
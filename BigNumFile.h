@@ -0,0 +1,315 @@
+#pragma once
+// BigInteger stores mapped from disk and the parallel text loader, kept apart
+// from BigNum.h so that only their users pull in the file system headers
+#include "BigNum.h"
+#include <fstream>
+#include <thread>
+#include <atomic>
+#include <exception>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// appends BigIntegers to a store file without holding them, only the offsets
+// table is kept in memory until close writes it after the limbs
+class BigIntegerStoreWriter {
+public:
+    explicit BigIntegerStoreWriter(const std::string& path) : out(path, std::ios::binary | std::ios::trunc) {
+        if (!out) throw std::runtime_error("invalid argument - cannot create " + path + ".");
+        writeBinaryHeader(out, BINARY_INTEGER, BINARY_STORE);
+    }
+
+    BigIntegerStoreWriter(const BigIntegerStoreWriter&) = delete;
+
+    BigIntegerStoreWriter& operator=(const BigIntegerStoreWriter&) = delete;
+
+    ~BigIntegerStoreWriter() {
+        if (out.is_open()) {
+            try {
+                close();
+            }
+            catch (const std::exception&) {
+            }
+        }
+    }
+
+    void push_back(BigIntegerView value) {
+        offsets.push_back(heapSize * 2 + (value.getSign() < 0 ? 1 : 0));
+        writeBinaryWords(out, value.data(), value.size());
+        heapSize += value.size();
+    }
+
+    void push_back(const BigInteger& value) {
+        push_back(BigIntegerView(value));
+    }
+
+    void close() {
+        offsets.push_back(heapSize * 2);
+        uint64_t count = offsets.size() - 1;
+        for (uint64_t& offset : offsets) offset = littleEndianWord(offset);
+        writeBinaryWords(out, offsets.data(), offsets.size());
+        count = littleEndianWord(count);
+        writeBinaryWords(out, &count, 1);
+        out.close();
+        if (!out) throw std::runtime_error("invalid argument - cannot write BigInteger store.");
+    }
+
+private:
+    std::ofstream out;
+    std::vector<uint64_t> offsets;
+    uint64_t heapSize = 0;
+};
+
+// a whole file as read-only memory, mapped with mmap on POSIX systems so
+// that the pages are never copied; memory mapping is POSIX only, elsewhere
+// the file is read into a buffer; data() is aligned for uint64_t either way
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+#if defined(__unix__) || defined(__APPLE__)
+        int fd = ::open(path.c_str(), O_RDONLY);
+        struct stat info;
+        if (fd < 0 || ::fstat(fd, &info) != 0) {
+            if (fd >= 0) ::close(fd);
+            throw std::runtime_error("invalid argument - cannot open " + path + ".");
+        }
+        length = static_cast<size_t>(info.st_size);
+        if (length > 0) {
+            void* address = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+            if (address != MAP_FAILED) mapped = address;
+        }
+        ::close(fd);
+        if (mapped == nullptr && length > 0) throw std::runtime_error("invalid argument - cannot map " + path + ".");
+        bytes = static_cast<const char*>(mapped);
+#else
+        std::ifstream in(path, std::ios::binary | std::ios::ate);
+        if (!in) throw std::runtime_error("invalid argument - cannot open " + path + ".");
+        length = static_cast<size_t>(in.tellg());
+        words.resize((length + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+        in.seekg(0);
+        if (!in.read(reinterpret_cast<char*>(words.data()), static_cast<std::streamsize>(length))) {
+            throw std::runtime_error("invalid argument - cannot read " + path + ".");
+        }
+        bytes = reinterpret_cast<const char*>(words.data());
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+#if defined(__unix__) || defined(__APPLE__)
+        if (mapped != nullptr) ::munmap(mapped, length);
+#endif
+    }
+
+    const char* data() const {
+        return bytes;
+    }
+
+    size_t size() const {
+        return length;
+    }
+
+private:
+    const char* bytes = nullptr;
+    size_t length = 0;
+#if defined(__unix__) || defined(__APPLE__)
+    void* mapped = nullptr;
+#else
+    std::vector<uint64_t> words;
+#endif
+};
+
+// read-only store file in a MappedFile: elements are views on its limbs, so
+// on POSIX systems scans stream through the page cache and nothing is copied, the
+// offsets table is checked when the file is opened and the top limb of an
+// element when it is taken
+class BigIntegerStore {
+public:
+    explicit BigIntegerStore(const std::string& path) : file(path) {
+        if constexpr (std::endian::native == std::endian::big) {
+            throw std::runtime_error("invalid argument - BigInteger stores need a little-endian host.");
+        }
+        words = reinterpret_cast<const uint64_t*>(file.data());
+        check();
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    BigIntegerView operator[](size_t index) const {
+        const uint64_t* limbs = heap + offsets[index] / 2;
+        const size_t length = static_cast<size_t>(offsets[index + 1] / 2 - offsets[index] / 2);
+        const bool negative = (offsets[index] & 1) != 0;
+        if (length == 0 ? negative : limbs[length - 1] == 0) {
+            throw std::runtime_error("invalid argument - corrupt BigInteger store.");
+        }
+        return BigIntegerView(limbs, length, negative ? -1 : 1);
+    }
+
+private:
+    MappedFile file;
+    const uint64_t* words = nullptr;
+    const uint64_t* heap = nullptr;
+    const uint64_t* offsets = nullptr;
+    size_t count = 0;
+
+    // header word, limbs, count + 1 offsets and the count: the heap ends where
+    // the offsets start and the last offset says so
+    void check() {
+        const char expected[8] = { 'B', 'G', 'N', static_cast<char>(BINARY_VERSION), static_cast<char>(BINARY_INTEGER), static_cast<char>(BINARY_STORE), 0, 0 };
+        const size_t total = file.size() / 8;
+        bool valid = file.size() % 8 == 0 && total >= 3 && std::memcmp(words, expected, sizeof(expected)) == 0;
+        if (valid) {
+            count = static_cast<size_t>(words[total - 1]);
+            valid = count <= total - 3;
+        }
+        if (valid) {
+            offsets = words + total - 2 - count;
+            heap = words + 1;
+            const uint64_t heapSize = static_cast<uint64_t>(offsets - heap);
+            valid = offsets[count] == heapSize * 2;
+            for (size_t i = 0; valid && i < count; ++i) valid = offsets[i] / 2 <= offsets[i + 1] / 2;
+        }
+        if (!valid) throw std::runtime_error("invalid argument - not a BigInteger store.");
+    }
+};
+
+// runs task(0) .. task(count - 1) on up to threads workers that each take the
+// next index, the first exception thrown by a task is rethrown after the join
+template <typename Task>
+void parallelFor(size_t count, unsigned threads, Task task) {
+    std::atomic<size_t> next{ 0 };
+    std::exception_ptr error;
+    std::atomic<bool> failed{ false };
+    auto worker = [&]() {
+        for (size_t i = next++; i < count && !failed; i = next++) {
+            try {
+                task(i);
+            }
+            catch (...) {
+                if (!failed.exchange(true)) error = std::current_exception();
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads && t < count; ++t) pool.emplace_back(worker);
+    worker();
+    for (std::thread& thread : pool) thread.join();
+    if (error) std::rethrow_exception(error);
+}
+
+inline bool isTextSpace(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+inline const char* skipTextSpace(const char* first, const char* last) {
+    while (first != last && isTextSpace(*first)) ++first;
+    return first;
+}
+
+// end of the token at first, stopping before whitespace or stop
+inline const char* textTokenEnd(const char* first, const char* last, char stop) {
+    while (first != last && !isTextSpace(*first) && *first != stop) ++first;
+    return first;
+}
+
+// end of the number text at first, a BigRational may have whitespace around
+// its '/', the same rules as the stream extractors
+inline const char* numberTextEnd(const char* first, const char* last, const BigInteger*) {
+    return textTokenEnd(first, last, ' ');
+}
+
+inline const char* numberTextEnd(const char* first, const char* last, const BigRational*) {
+    const char* end = textTokenEnd(first, last, '/');
+    const char* slash = skipTextSpace(end, last);
+    if (slash == last || *slash != '/') return end;
+    return textTokenEnd(skipTextSpace(slash + 1, last), last, ' ');
+}
+
+// a whole [+-]digits token
+inline bool parseNumberText(const char* first, const char* last, BigInteger& value) {
+    if (first != last && *first == '+' && last - first > 1 && first[1] != '-') ++first;
+    std::from_chars_result result = from_chars(first, last, value);
+    return result.ec == std::errc() && result.ptr == last;
+}
+
+inline bool parseNumberText(const char* first, const char* last, BigRational& value) {
+    const char* end = textTokenEnd(first, last, '/');
+    BigInteger numerator, denominator(1);
+    if (!parseNumberText(first, end, numerator)) return false;
+    const char* slash = skipTextSpace(end, last);
+    if (slash != last) {
+        if (*slash != '/' || !parseNumberText(skipTextSpace(slash + 1, last), last, denominator)) return false;
+        if (getNumber(denominator).empty()) return false;
+    }
+    value = normalize(numerator, denominator);
+    return true;
+}
+
+// a boundary between chunks has to start a value: the first char after a
+// whitespace run that neither follows nor precedes the '/' of a BigRational
+inline const char* numberTextBoundary(const char* first, const char* begin, const char* last) {
+    while (first != last) {
+        while (first != last && !isTextSpace(*first)) ++first;
+        const char* before = first;
+        while (before != begin && isTextSpace(before[-1])) --before;
+        first = skipTextSpace(first, last);
+        if (first == last || (*first != '/' && (before == begin || before[-1] != '/'))) return first;
+    }
+    return last;
+}
+
+// loads every whitespace separated BigInteger or BigRational of a text file
+// into values in file order: the mapped file is cut into chunks at value
+// boundaries, the values of each chunk are counted in parallel, and once the
+// vector is sized every chunk parses straight into its own slots
+template <typename T>
+void loadNumbers(const std::string& path, std::vector<T>& values, unsigned threads = 0) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    MappedFile file(path);
+    const char* begin = file.data();
+    const char* last = begin + file.size();
+
+    const size_t minChunk = size_t(1) << 16;
+    const size_t chunks = std::max<size_t>(1, std::min<size_t>(size_t(threads) * 8, file.size() / minChunk));
+    std::vector<const char*> bounds(chunks + 1, last);
+    bounds[0] = begin;
+    for (size_t i = 1; i < chunks; ++i) {
+        bounds[i] = std::max(bounds[i - 1], numberTextBoundary(begin + file.size() / chunks * i, begin, last));
+    }
+
+    // every chunk walks the values that start inside it
+    auto walk = [&](size_t chunk, auto&& visit) {
+        const char* p = skipTextSpace(bounds[chunk], last);
+        while (p < bounds[chunk + 1]) {
+            const char* end = numberTextEnd(p, last, static_cast<const T*>(nullptr));
+            visit(p, end);
+            p = skipTextSpace(end, last);
+        }
+    };
+
+    std::vector<size_t> offsets(chunks + 1, 0);
+    parallelFor(chunks, threads, [&](size_t chunk) {
+        walk(chunk, [&](const char*, const char*) { ++offsets[chunk + 1]; });
+    });
+    for (size_t i = 0; i < chunks; ++i) offsets[i + 1] += offsets[i];
+
+    values.clear();
+    values.resize(offsets[chunks]);
+    parallelFor(chunks, threads, [&](size_t chunk) {
+        size_t index = offsets[chunk];
+        walk(chunk, [&](const char* first, const char* end) {
+            if (!parseNumberText(first, end, values[index++])) {
+                throw std::runtime_error("invalid argument - bad number at byte " + std::to_string(first - begin) + " of " + path + ".");
+            }
+        });
+    });
+}
@@ -1,9 +1,19 @@
 #include <iostream>
 #include <sstream>
+#include <iomanip>
+#include <cstdio>
 #include <cassert>
+#include <atomic>
+
+// counts limb buffers taken from the heap so the tests can check the allocation free paths
+static std::atomic<size_t> limbAllocations{ 0 };
+#define LIMB_ALLOCATION_HOOK() (++limbAllocations)
+
 #include "BigNum.h"
+#include "BigNumFile.h"
 #include <stdexcept>
 #include <functional>
+#include <thread>
 
 void testBigIntegerInputStream() {
     BigInteger bigInt;
@@ -68,8 +78,13 @@ std::string toString(const BigRational& bigRational) {
     return oss.str();
 }
 
+// numerator and denominator as stored, so the tests can see the canonical form
+std::string termsToString(const BigRational& bigRational) {
+    return toString(getNumerator(bigRational)) + "/" + toString(getDenominator(bigRational));
+}
+
 
-std::string vectorToString(const std::vector<int>& v) {
+std::string vectorToString(const LimbVector& v) {
     std::string result;
     for (auto it = v.begin();
         it != v.end(); ++it) {  //  ,       
@@ -96,6 +111,24 @@ void runTest(const std::string& testName, const std::function<std::string()>& te
     }
 }
 
+template <typename F>
+std::string limbAllocationsDuring(F f) {
+    const size_t before = limbAllocations;
+    f();
+    return std::to_string(limbAllocations - before);
+}
+
+// xorshift64 with a fixed seed, so the limb tests see the same operands on every run
+struct XorShift {
+    uint64_t seed = 88172645463325252ULL;
+    uint64_t operator()() {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        return seed;
+    }
+};
+
 
 int main() {
     try {
@@ -519,7 +552,7 @@ int main() {
             "81");
 
         runTest("Test 1", []() {
-            return vectorToString(naive_mul({ 1, 2, 3 }, { 4, 5, 6 }));
+            return vectorToString(naive_mul({ 123 }, { 456 }));
             }, "56088");  //  : "56088"
 
 
@@ -530,12 +563,12 @@ int main() {
 
             //     
         runTest("Multiplication of Different Lengths", []() {
-            return vectorToString(naive_mul({ 1, 2, 3 }, { 4 }));
+            return vectorToString(naive_mul({ 123 }, { 4 }));
             }, "492");  //  : "492"
 
             //    
         runTest("Large Number Multiplication", []() {
-            return vectorToString(naive_mul({ 9, 8, 7, 6, 5 }, { 5, 4, 3, 2, 1 }));
+            return vectorToString(naive_mul({ 98765 }, { 54321 }));
             }, "5365013565");  //  : "5185478065"
 
         runTest("Division by Zero",
@@ -842,6 +875,422 @@ int main() {
     // Negative Numbers
     runTest("Negative Modulus Test", []() { return toString(BigInteger("-50") % BigInteger("7")); }, "-1");
     runTest("Mixed Sign Modulus Test", []() { return toString(BigInteger("50") % BigInteger("-7")); }, "1");
+    runTest("Divmod Positive By Positive", []() {
+        auto [q, r] = divmod(BigInteger("50"), BigInteger("7"));
+        return toString(q) + " " + toString(r);
+        }, "7 1");
+    runTest("Divmod Negative By Positive", []() {
+        auto [q, r] = divmod(BigInteger("-50"), BigInteger("7"));
+        return toString(q) + " " + toString(r);
+        }, "-7 -1");
+    runTest("Divmod Positive By Negative", []() {
+        auto [q, r] = divmod(BigInteger("50"), BigInteger("-7"));
+        return toString(q) + " " + toString(r);
+        }, "-7 1");
+    runTest("Divmod Negative By Negative", []() {
+        auto [q, r] = divmod(BigInteger("-50"), BigInteger("-7"));
+        return toString(q) + " " + toString(r);
+        }, "7 -1");
+    {
+        // gcd(F(m), F(n)) = F(gcd(m, n)) for Fibonacci numbers
+        std::vector<BigInteger> fib = { BigInteger(0), BigInteger(1) };
+        while (fib.size() <= 1500) fib.push_back(fib[fib.size() - 1] + fib[fib.size() - 2]);
+        runTest("GCD Fibonacci", [&fib]() { return toString(gcd(fib[1200], fib[1500])); }, toString(fib[300]));
+        runTest("GCD Fibonacci Negative Operand", [&fib]() { return toString(gcd(-fib[1200] * fib[7], fib[1500])); },
+            toString(fib[300]));
+    }
+    runTest("GCD Opposite Signs", []() { return toString(gcd(BigInteger(-12), BigInteger(18))); }, "6");
+    runTest("GCD With Zero", []() { return toString(gcd(BigInteger(0), BigInteger(-5))); }, "5");
+    runTest("gcd64", []() { return std::to_string(gcd64(48, 18)); }, "6");
+    runTest("gcd64 With Zero", []() { return std::to_string(gcd64(0, 7)); }, "7");
+    runTest("Two limb GCD", []() {
+        // 2^100 * 3 and 2^70 * 9 share 2^70 * 3
+        return toString(gcd(BigInteger("3802951800684688204490109616128"), BigInteger("10625324586456701730816")));
+        }, "3541774862152233910272");
+    runTest("Two limb GCD does not allocate", []() {
+        BigInteger a("123456789012345678901234567890"), b("-98765432109876543210"), g;
+        return limbAllocationsDuring([&]() { g = gcd(a, b); });
+        }, "0");
+    {
+        // 3^65536 and 7^32768 run through the half gcd, c is their common factor
+        BigInteger a(3), b(7);
+        for (int i = 0; i < 16; ++i) a = a.square();
+        for (int i = 0; i < 15; ++i) b = b.square();
+        const BigInteger c("18446744073709551629");
+        BigInteger x, y;
+        const BigInteger g = extendedGcd(a * c, b * c, x, y);
+        runTest("Extended GCD Half GCD", [&g]() { return toString(g); }, "18446744073709551629");
+        runTest("Extended GCD Half GCD Bezout Identity", [&]() { return toString(a * c * x + b * c * y); },
+            "18446744073709551629");
+        runTest("GCD Half GCD Negative Operand", [&]() { return toString(gcd(a * c, -b * c)); }, "18446744073709551629");
+        runTest("BigModulus Inverse Half GCD", [&a, &b]() {
+            BigModulus modulus(b);
+            return toString(modulus.mulmod(a, modulus.inverse(a)));
+            }, "1");
+    }
+    {
+        BigInteger x, y;
+        const BigInteger g = extendedGcd(BigInteger(240), BigInteger(-46), x, y);
+        runTest("Extended GCD Small", [&g]() { return toString(g); }, "2");
+        runTest("Extended GCD Small First Cofactor", [&x]() { return toString(x); }, "-9");
+        runTest("Extended GCD Small Second Cofactor", [&y]() { return toString(y); }, "-47");
+        runTest("Extended GCD Small Bezout Identity", [&x, &y]() { return toString(BigInteger(240) * x + BigInteger(-46) * y); }, "2");
+    }
+    runTest("BigModulus Small Inverse", []() { return toString(BigModulus(BigInteger(11)).inverse(BigInteger(-3))); }, "7");
+    runTest("BigModulus Word Sized Reduce", []() {
+        BigModulus word(BigInteger(1000000007));
+        return toString(word.reduce(BigInteger("123456789012345678901234567890")));
+        }, "197434842");
+    runTest("BigModulus Word Sized Powmod", []() {
+        BigModulus word(BigInteger(1000000007));
+        return toString(word.powmod(BigInteger(2), BigInteger(100)));
+        }, "976371285");
+    runTest("BigModulus Barrett Reduce", []() {
+        BigModulus even(BigInteger("1000000000000000000000000000002"));
+        BigInteger negative(-1);
+        for (int i = 0; i < 50; ++i) negative *= BigInteger(7);
+        return toString(even.reduce(negative));
+        }, "587853379719659433947580834047");
+    runTest("BigModulus Barrett Mulmod", []() {
+        BigModulus even(BigInteger("1000000000000000000000000000002"));
+        return toString(even.mulmod(BigInteger("999999999999999999999999999999"), BigInteger(-2)));
+        }, "6");
+    runTest("BigModulus Barrett Powmod", []() {
+        BigModulus even(BigInteger("1000000000000000000000000000002"));
+        return toString(even.powmod(BigInteger(123456789), BigInteger(987654321)));
+        }, "178351717548433282551576318309");
+    runTest("BigModulus Montgomery Powmod", []() {
+        BigModulus mersenne(BigInteger("170141183460469231731687303715884105727"));
+        return toString(mersenne.powmod(BigInteger(3), BigInteger(12345)));
+        }, "160811921031045027555084391440524285415");
+    runTest("BigModulus Montgomery Fermat", []() {
+        BigModulus mersenne(BigInteger("170141183460469231731687303715884105727"));
+        return toString(mersenne.powmod(BigInteger(3), mersenne.modulus() - BigInteger(1)));
+        }, "1");
+    runTest("BigModulus Inverse", []() {
+        BigModulus mersenne(BigInteger("170141183460469231731687303715884105727"));
+        return toString(mersenne.inverse(BigInteger(-12345)));
+        }, "148613396618407430195446269418256647392");
+    runTest("BigModulus Inverse Does Not Exist", []() {
+        BigModulus even(BigInteger("1000000000000000000000000000002"));
+        try {
+            even.inverse(BigInteger(4));
+        }
+        catch (const std::runtime_error&) {
+            return std::string("runtime_error");
+        }
+        return std::string("no exception");
+        }, "runtime_error");
+    runTest("BigModulus Shared By Threads", []() {
+        const BigModulus shared(BigInteger("1000000000000000000000000000002"));
+        auto chain = [&shared](int64_t start) {
+            BigInteger x(start);
+            for (int i = 0; i < 2000; ++i) x = shared.mulmod(x, x + BigInteger(1));
+            return toString(x);
+        };
+        std::vector<std::string> results(4);
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < results.size(); ++t) {
+            threads.emplace_back([&chain, &results, t]() { results[t] = chain(static_cast<int64_t>(t) + 2); });
+        }
+        for (std::thread& thread : threads) thread.join();
+        for (size_t t = 0; t < results.size(); ++t) {
+            if (results[t] != chain(static_cast<int64_t>(t) + 2)) return "thread " + std::to_string(t);
+        }
+        return std::string("ok");
+        }, "ok");
+    runTest("Divmod Large Test", []() {
+        auto [q, r] = divmod(BigInteger("123456789012345678901234567890123"), BigInteger("-98765432109876543210"));
+        return toString(q) + " " + toString(r);
+        }, "-1249999988609 37037052338271595233");
+    {
+        BigInteger power(1);
+        for (int i = 0; i < 1500; ++i) power *= BigInteger(10);
+        assert((power - BigInteger(1)).toString() == std::string(1500, '9'));
+        assert(power.toString() == "1" + std::string(1500, '0'));
+        std::string text = "-3" + std::string(1200, '0') + "14" + std::string(700, '9');
+        std::ostringstream os;
+        os << std::setw(8) << BigInteger(-42) << BigInteger(text);
+        assert(os.str() == "     -42" + text);
+    }
+    {
+        std::string digits;
+        for (int i = 0; i < 3000; ++i) digits += static_cast<char>('0' + (i * 7 + i / 13) % 10);
+        runTest("Long Decimal Input Leading Zeros", [&digits]() {
+            return toString(BigInteger("-" + std::string(100000, '0') + "1" + digits));
+            }, "-1" + digits);
+    }
+    runTest("Long Decimal Input Power Of Ten", []() {
+        return toString(BigInteger("1" + std::string(1500, '0')) - BigInteger(std::string(1500, '9')));
+        }, "1");
+    runTest("Long Decimal Input Negative Zero", []() {
+        return toString(BigInteger("-" + std::string(5000, '0')));
+        }, "0");
+    runTest("Long Decimal Input Rejects Bad Digit", []() {
+        try {
+            BigInteger(std::string(40, '1') + "/" + std::string(40, '1'));
+        }
+        catch (const std::invalid_argument&) {
+            return std::string("invalid_argument");
+        }
+        return std::string("no exception");
+        }, "invalid_argument");
+    {
+        const std::string csv = "-00123456789012345678901234567890,ff,x";
+        BigInteger first, second, third(7);
+        auto a = from_chars(csv.data(), csv.data() + csv.size(), first);
+        auto b = from_chars(a.ptr + 1, csv.data() + csv.size(), second, 16);
+        auto c = from_chars(b.ptr + 1, csv.data() + csv.size(), third);
+        assert(c.ec == std::errc::invalid_argument);
+        assert(third == BigInteger(7));
+        char buffer[40];
+        auto d = to_chars(buffer, buffer + sizeof(buffer), first);
+        runTest("to_chars Decimal", [&]() { return std::string(buffer, d.ptr); },
+            "-123456789012345678901234567890");
+        auto e = to_chars(buffer, buffer + 8, first);
+        assert(e.ec == std::errc::value_too_large);
+        auto f = to_chars(buffer, buffer + sizeof(buffer), second, 2);
+        runTest("from_chars Hex to_chars Binary", [&]() { return std::string(buffer, f.ptr); }, "11111111");
+        runTest("BigInteger from string_view",
+            [&csv]() { return toString(BigInteger(std::string_view(csv).substr(3, 5))); }, "12345");
+    }
+    {
+        const std::vector<BigInteger> integers = { BigInteger(0), BigInteger(-1), BigInteger("-340282366920938463463374607431768211456") };
+        const std::vector<BigRational> rationals = { BigRational(-2, 3), BigRational(0, 5), BigRational(1, std::numeric_limits<int64_t>::min()) };
+        std::stringstream stream;
+        writeBinary(stream, integers);
+        writeBinary(stream, rationals);
+        writeBinary(stream, BigRational(7, 9));
+        const std::string bytes = stream.str();
+        std::vector<BigInteger> integersBack;
+        std::vector<BigRational> rationalsBack;
+        BigRational single;
+        readBinary(stream, integersBack);
+        readBinary(stream, rationalsBack);
+        readBinary(stream, single);
+        assert(stream);
+        assert(integersBack == integers);
+        assert(rationalsBack == rationals);
+        assert(single == BigRational(7, 9));
+        runTest("Binary Round Trip Size", [&bytes]() { return std::to_string(bytes.size()); }, "216");
+
+        std::istringstream truncated(bytes.substr(0, 40));
+        readBinary(truncated, integersBack);
+        assert(!truncated);
+        assert(integersBack == integers);
+
+        std::istringstream wrongKind(bytes);
+        BigInteger integer(5);
+        readBinary(wrongKind, integer);
+        assert(!wrongKind);
+        assert(integer == BigInteger(5));
+
+        // the third integer starts at byte 40 and has three limbs, cut after the first
+        std::istringstream shortValue(bytes.substr(40, 16));
+        BigInteger big(7);
+        readBinaryValue(shortValue, big);
+        assert(!shortValue);
+        assert(big == BigInteger(7));
+
+        // the trailing 7/9 with the sign bit of its denominator length set
+        std::string negativeDenominator = bytes.substr(bytes.size() - 40);
+        negativeDenominator[24] |= 1;
+        std::istringstream badRational(negativeDenominator);
+        BigRational rational(3, 4);
+        readBinary(badRational, rational);
+        assert(!badRational);
+        assert(rational == BigRational(3, 4));
+    }
+    {
+        const std::string path = "bignum_store_test.bin";
+        const std::vector<BigInteger> values = { BigInteger(0), BigInteger("-123456789012345678901234567890"), BigInteger(42), BigInteger("98765432109876543210") };
+        {
+            BigIntegerStoreWriter writer(path);
+            for (const BigInteger& value : values) writer.push_back(value);
+        }
+        {
+            BigIntegerStore store(path);
+            const BigInteger zero(0);
+            assert(store.size() == values.size());
+            for (size_t i = 0; i < store.size(); ++i) assert(store[i].toBigInteger() == values[i]);
+            assert(store[3] > store[2]);
+            assert(store[1] < BigIntegerView(zero));
+            assert(store[0] == BigIntegerView(zero));
+            runTest("Mapped BigInteger Store Sum", [&store]() { return toString(store[1] + store[3]); },
+                "-123456788913580246791358024680");
+            runTest("Mapped BigInteger Store Product", [&store]() { return toString(store[2] * store[1]); },
+                "-5185185138518518513851851851380");
+        }
+        std::remove(path.c_str());
+    }
+    {
+        const std::string path = "bignum_loader_test.txt";
+        {
+            std::ofstream out(path);
+            out << "  -4/6 7\n12345678901234567890123 / -10\t+3\n\n0/5 ";
+        }
+        std::vector<BigRational> rationals;
+        loadNumbers(path, rationals, 3);
+        runTest("Parallel Text Loader Count",
+            [&rationals]() { return std::to_string(rationals.size()); },
+            "5");
+        assert(rationals[0] == BigRational(-2, 3));
+        assert(rationals[1] == BigRational(7, 1));
+        assert(rationals[2] == BigRational("-12345678901234567890123", "10"));
+        assert(rationals[3] == BigRational(3, 1));
+        assert(rationals[4] == BigRational());
+        runTest("Parallel Text Loader Reports Bad Number",
+            [&path]() {
+                std::vector<BigInteger> integers;
+                try {
+                    loadNumbers(path, integers);
+                }
+                catch (const std::runtime_error& e) {
+                    return std::string(e.what());
+                }
+                return std::string("no exception");
+            },
+            "invalid argument - bad number at byte 2 of bignum_loader_test.txt.");
+        std::remove(path.c_str());
+    }
+    {
+        const std::string text = "12345 678 / 9 10";
+        const char* begin = text.data();
+        const char* last = begin + text.size();
+        runTest("Text Boundary Inside A Number",
+            [begin, last]() { return std::to_string(numberTextBoundary(begin + 2, begin, last) - begin); },
+            "6");
+        runTest("Text Boundary Skips The Rest Of A Rational",
+            [begin, last]() { return std::to_string(numberTextBoundary(begin + 7, begin, last) - begin); },
+            "14");
+        runTest("Text Boundary At The End",
+            [begin, last]() { return std::to_string(numberTextBoundary(begin + 15, begin, last) - begin); },
+            "16");
+    }
+    runTest("Parallel Text Loader Number Across A Chunk", []() {
+        // two 64 KiB chunks cut in the middle of a 100 digit number
+        const std::string path = "bignum_loader_number_test.txt";
+        const size_t chunk = size_t(1) << 16;
+        const std::string digits = "-" + std::string(99, '7');
+        std::string text;
+        auto fill = [&text](size_t until) {
+            for (int i = 0; text.size() < until; ++i) {
+                text += text.size() + 8 <= until ? std::to_string(1000000 + i) + " " : std::string(" ");
+            }
+        };
+        fill(chunk - 50);
+        text += digits + " ";
+        fill(2 * chunk);
+        {
+            std::ofstream out(path, std::ios::binary);
+            out << text;
+        }
+        std::vector<BigInteger> loaded;
+        loadNumbers(path, loaded, 2);
+        std::remove(path.c_str());
+
+        std::istringstream in(text);
+        std::vector<BigInteger> parsed;
+        BigInteger value;
+        while (in >> value) parsed.push_back(value);
+        if (std::find(loaded.begin(), loaded.end(), BigInteger(digits)) == loaded.end()) return std::string("lost");
+        return std::string(loaded == parsed ? "same" : "different");
+        }, "same");
+    runTest("Parallel Text Loader Across Chunks", []() {
+        // 4 * 64 KiB gives four chunks, a rational with spaces around its
+        // slash straddles every cut: before the slash, on it and after it
+        const std::string path = "bignum_loader_chunks_test.txt";
+        const size_t chunk = size_t(1) << 16;
+        const std::string straddling[3] = { "-22 \t/7", "355/ -113", "-1 /  3" };
+        const size_t at[3] = { 3, 3, 4 };
+        std::string text;
+        auto fill = [&text](size_t until) {
+            for (int i = 0; text.size() < until; ++i) {
+                text += text.size() + 8 <= until ? std::to_string(1000000 + i) + " " : std::string(" ");
+            }
+        };
+        for (size_t i = 0; i < 3; ++i) {
+            fill(chunk * (i + 1) - at[i]);
+            text += straddling[i] + " ";
+        }
+        fill(4 * chunk);
+        {
+            std::ofstream out(path, std::ios::binary);
+            out << text;
+        }
+        std::vector<BigRational> loaded;
+        loadNumbers(path, loaded, 2);
+        std::remove(path.c_str());
+
+        // operator>> takes a rational as one token, so the sequential parse
+        // reads the text with the whitespace around every '/' dropped
+        std::string compact;
+        for (char c : text) {
+            if (c == '/') {
+                while (!compact.empty() && std::isspace(static_cast<unsigned char>(compact.back()))) compact.pop_back();
+            }
+            if (std::isspace(static_cast<unsigned char>(c)) && !compact.empty() && compact.back() == '/') continue;
+            compact += c;
+        }
+        std::istringstream in(compact);
+        std::vector<BigRational> parsed;
+        BigRational value;
+        while (in >> value) parsed.push_back(value);
+        return std::string(loaded == parsed ? "same" : "different");
+        }, "same");
+    runTest("Hexadecimal Output", []() {
+        std::ostringstream out;
+        out << std::hex << BigInteger("-123456789012345678901234567890");
+        return out.str();
+        }, "-18ee90ff6c373e0ee4e3f0ad2");
+    runTest("Hexadecimal Output With Showbase And Uppercase", []() {
+        std::ostringstream out;
+        out << std::hex << std::showbase << std::uppercase << BigInteger("-123456789012345678901234567890");
+        return out.str();
+        }, "-0X18EE90FF6C373E0EE4E3F0AD2");
+    runTest("Octal Output With Showbase", []() {
+        std::ostringstream out;
+        out << std::oct << std::showbase << BigInteger(64);
+        return out.str();
+        }, "0100");
+    runTest("Hexadecimal Rational Output", []() {
+        std::ostringstream out;
+        out << std::hex << std::showbase << BigRational(-255, 16);
+        return out.str();
+        }, "-0xff/0x10");
+    runTest("Hexadecimal Input With Prefix", []() {
+        std::istringstream in("-0x18EE90FF6C373E0EE4E3F0AD2");
+        BigInteger value;
+        in >> std::hex >> value;
+        return toString(value);
+        }, "-123456789012345678901234567890");
+    runTest("Octal Input", []() {
+        std::istringstream in("777");
+        BigInteger value;
+        in >> std::oct >> value;
+        return toString(value);
+        }, "511");
+    runTest("Hexadecimal Rational Input", []() {
+        std::istringstream in("ff/-10");
+        BigRational value;
+        in >> std::hex >> value;
+        return toString(value);
+        }, "-255/16");
+    runTest("Binary toString", []() {
+        return BigInteger("-123456789012345678901234567890").toString(2).substr(0, 9);
+        }, "-11000111");
+    runTest("Base 36 Constructor", []() {
+        return BigInteger("zz", 36).toString();
+        }, "1295");
+    runTest("toString Rejects Bad Base", []() {
+        try {
+            BigInteger(35).toString(37);
+        }
+        catch (const std::invalid_argument&) {
+            return std::string("invalid_argument");
+        }
+        return std::string("no exception");
+        }, "invalid_argument");
     auto v = std::numeric_limits<int64_t>::max();
     auto MinusvPlusOne = std::numeric_limits<int64_t>::min();
     f = BigInteger((int64_t)v);
@@ -907,6 +1356,40 @@ int main() {
             return toString(BigRational(std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::min()));
         },
         "1");
+    runTest("Constructor from int64_t negative numerator",
+        []() { return termsToString(BigRational(-4, 6)); },
+        "-2/3");
+    runTest("Constructor from int64_t negative denominator",
+        []() { return termsToString(BigRational(4, -6)); },
+        "-2/3");
+    runTest("Constructor from int64_t zero over negative",
+        []() { return termsToString(BigRational(0, -3)); },
+        "0/1");
+    runTest("Constructor from int64_t min denominator",
+        []() { return termsToString(BigRational(1, std::numeric_limits<int64_t>::min())); },
+        "-1/9223372036854775808");
+    {
+        const BigRational third(1, 3);
+        std::vector<BigRational> values(3, -third);
+        BigRational copy = values[1];
+        BigRational moved = std::move(values[2]);
+        values[0] = moved;
+        runTest("Copy keeps the canonical form",
+            [&copy]() { return termsToString(copy); },
+            "-1/3");
+        runTest("Move keeps the canonical form",
+            [&moved]() { return termsToString(moved); },
+            "-1/3");
+        runTest("Copy assignment keeps the canonical form",
+            [&values]() { return termsToString(values[0]); },
+            "-1/3");
+        runTest("Moved-from BigRational is zero",
+            [&values]() { return termsToString(values[2]); },
+            "0/1");
+        runTest("Moved-from BigRational stays usable",
+            [&values, &third]() { return termsToString(values[2] + third); },
+            "1/3");
+    }
 
     runTest("Constructor from string max / max",
         []() { return toString(BigRational("9223372036854775807", "9223372036854775807")); },
@@ -964,6 +1447,68 @@ int main() {
     runTest("Division Operator",
         []() { return toString(BigRational(1, 2) / BigRational(2, 3)); },
         "3/4");
+    {
+        // single-limb terms whose results need two limbs, or the long way
+        const BigRational a("18446744073709551615", "18446744073709551613");
+        const BigRational b("18446744073709551613", "18446744073709551611");
+        const BigRational max(std::numeric_limits<int64_t>::max(), 1);
+        const BigRational min(std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max());
+        runTest("Word Sized Addition",
+            [&a, &b]() { return toString(a + b); },
+            "680564733841876926705388285979021803534/340282366920938463315800654842091798543");
+        runTest("Word Sized Subtraction",
+            [&a, &b]() { return toString(a - b); },
+            "-4/340282366920938463315800654842091798543");
+        runTest("Word Sized Multiplication",
+            [&a, &b]() { return toString(a * b); },
+            "18446744073709551615/18446744073709551611");
+        runTest("Word Sized Division",
+            [&a, &b]() { return toString(a / b); },
+            "340282366920938463352694142989510901765/340282366920938463352694142989510901769");
+        runTest("Word Sized Addition Carry",
+            [&max]() { return toString(max + max); },
+            "18446744073709551614");
+        runTest("Word Sized Multiplication Of Minimum",
+            [&min]() { return toString(min * min); },
+            "85070591730234615865843651857942052864/85070591730234615847396907784232501249");
+        assert(a < b);
+        assert(!(-a < -b));
+    }
+    {
+        BigRational harmonic, telescoping;
+        for (int64_t k = 1; k <= 30; ++k) {
+            harmonic += BigRational(1, k);
+            telescoping -= BigRational(1, k * (k + 1));
+        }
+        const BigRational product = BigRational(6, 35) * BigRational(14, 9);
+        const BigRational quotient = BigRational(6, 35) / BigRational(-9, 14);
+        const BigRational difference = harmonic - harmonic;
+        runTest("Henrici Sum",
+            [&harmonic]() { return termsToString(harmonic); },
+            "9304682830147/2329089562800");
+        runTest("Henrici Difference",
+            [&telescoping]() { return termsToString(telescoping); },
+            "-30/31");
+        runTest("Henrici Difference To Zero",
+            [&difference]() { return termsToString(difference); },
+            "0/1");
+        runTest("Cross-Cancelled Product",
+            [&product]() { return termsToString(product); },
+            "4/15");
+        runTest("Cross-Cancelled Quotient",
+            [&quotient]() { return termsToString(quotient); },
+            "-4/15");
+        runTest("Cancelling Results Are Canonical",
+            [&]() {
+                for (const BigRational& value : { harmonic, telescoping, difference, product, quotient }) {
+                    BigRational normalized = value;
+                    normalized.normalize();
+                    if (termsToString(normalized) != termsToString(value)) return "not canonical: " + termsToString(value);
+                }
+                return std::string("ok");
+            },
+            "ok");
+    }
 
     //// Tests for Equality Operator
     runTest("Equality Operator",
@@ -998,6 +1543,50 @@ int main() {
     runTest("Greater Than or Equal Operator",
         []() { return toString(BigRational(2, 3) >= BigRational(1, 2)); },
         "1");
+    runTest("Ordering of close and mixed sign values",
+        []() {
+            BigRational tiny("1", "1000000000000000000000000000000");
+            std::vector<BigRational> values = { BigRational(1, 3), BigRational(-1, 2), BigRational(2, 7),
+                BigRational(1, 3) + tiny, BigRational(), BigRational(1, 3) - tiny, BigRational(-1, 3) };
+            std::sort(values.begin(), values.end());
+            std::string result;
+            for (size_t i = 1; i < values.size(); ++i) {
+                if (!(values[i - 1] < values[i]) || values[i - 1] >= values[i] || values[i - 1] == values[i]) return std::string("order");
+            }
+            for (const BigRational& value : values) result += (value == BigRational(1, 3) ? "*" : value > BigRational() ? "+" : value < BigRational() ? "-" : "0");
+            return result;
+        },
+        "--0++*+");
+    runTest("Ordering by sign",
+        []() { return std::to_string(compareFractions(BigRational(-1, 2), BigRational("1", "1000000000000000000000000000000"))); },
+        "-1");
+    runTest("Ordering zero against a negative value",
+        []() { return std::to_string(compareFractions(BigRational(), BigRational(-1, 3))); },
+        "1");
+    runTest("Ordering by length",
+        []() { return std::to_string(compareFractions(BigRational("10000000000000000000000000000000000000000", "3"), BigRational(5, 7))); },
+        "1");
+    runTest("Ordering by length of negative values",
+        []() { return std::to_string(compareFractions(BigRational("-10000000000000000000000000000000000000000", "3"), BigRational(-5, 7))); },
+        "-1");
+    runTest("Ordering by word products",
+        []() { return std::to_string(compareFractions(BigRational(1, 3), BigRational(2, 7))); },
+        "1");
+    runTest("Ordering with equal denominators",
+        []() {
+            return std::to_string(compareFractions(BigRational("1000000000000000000000000000001", "3000000000000000000000000000000"),
+                BigRational("999999999999999999999999999997", "3000000000000000000000000000000")));
+        },
+        "1");
+    runTest("Ordering by cross multiplication",
+        []() {
+            return std::to_string(compareFractions(BigRational("1000000000000000000000000000000", "3000000000000000000000000000001"),
+                BigRational("1000000000000000000000000000001", "3000000000000000000000000000004")));
+        },
+        "-1");
+    runTest("Ordering of equal values",
+        []() { return std::to_string(compareFractions(BigRational(4, 2), BigRational(2, 1))); },
+        "0");
 
     //// Compound Assignment Operators Tests
     runTest("Compound Addition Assignment",
@@ -1081,6 +1670,102 @@ int main() {
         },
         "3/4");
 
+    {
+        std::istringstream is("6/8 -1/3 5 2/0 7x 9");
+        BigRational a, b, c, d(1, 2), e(1, 2), f;
+        is >> a >> b >> c;
+        assert(is);
+        runTest("Input Stream Operator Reduces",
+            [&a]() { return toString(a); },
+            "3/4");
+        runTest("Input Stream Operator Negative",
+            [&b]() { return toString(b); },
+            "-1/3");
+        runTest("Input Stream Operator Integer",
+            [&c]() { return toString(c); },
+            "5");
+        is >> d;
+        assert(is.fail());
+        assert(d == BigRational(1, 2));
+        is.clear();
+        is >> e;
+        assert(is.fail());
+        assert(e == BigRational(1, 2));
+        is.clear();
+        is >> f;
+        assert(f == BigRational(9, 1));
+        assert(is.eof());
+    }
+    runTest("Input Stream Operator Leaves Whitespace",
+        []() {
+            std::istringstream is("12 \nrest");
+            BigRational value;
+            is >> value;
+            std::string rest;
+            std::getline(is, rest);
+            return rest;
+        },
+        " ");
+    runTest("Input Stream Operator Space Before Slash Ends The Value",
+        []() {
+            std::istringstream is("-1 / 3");
+            BigRational value;
+            is >> value;
+            assert(value == BigRational(-1, 1));
+            std::string rest;
+            std::getline(is, rest);
+            return rest;
+        },
+        " / 3");
+    runTest("Input Stream Operator With noskipws Like int",
+        []() {
+            std::istringstream ints("7 8"), rationals("7 8");
+            int i = 0, j = 0;
+            BigRational a, b;
+            ints >> std::noskipws >> i >> j;
+            rationals >> std::noskipws >> a >> b;
+            assert(a == BigRational(7, 1));
+            return std::string(ints.fail() == rationals.fail() ? "same" : "different");
+        },
+        "same");
+    runTest("BigInteger Input Leaves Whitespace",
+        []() {
+            std::istringstream is("42\tx");
+            BigInteger value;
+            is >> value;
+            return std::to_string(is.get());
+        },
+        "9");
+
+    {
+        BigRationalAccumulator deferred(2), whole;
+        BigRational exact;
+        for (int64_t k = 1; k <= 200; ++k) {
+            BigRational term(1, k * k);
+            deferred += term;
+            whole += BigRational(k, 1);
+            exact += term;
+            if (k == 100) assert(deferred.value() == exact);
+        }
+        assert(deferred.value() == exact);
+        runTest("Accumulator Whole Terms",
+            [&whole]() { return toString(whole.value()); },
+            "20100");
+        for (int64_t k = 1; k <= 200; ++k) deferred -= BigRational(1, k * k);
+        runTest("Accumulator Subtracts Back To Zero",
+            [&deferred]() { return toString(deferred.value()); },
+            "0");
+    }
+
+    runTest("Normalize Negative Denominator",
+        []() {
+            BigRational raw;
+            setNumerator(raw, BigInteger(-6));
+            setDenominator(raw, BigInteger(-8));
+            return toString(raw.normalize());
+        },
+        "3/4");
+
     //// Special Cases Tests
     runTest("Zero Numerator",
         []() { return toString(BigRational(0, 1)); },
@@ -1237,6 +1922,102 @@ int main() {
         return toString(num3);
         }, "2998899812449910677529571999817489505831");
     // ... remaining Modulo and assign tests ...
+
+    // Large multiplication tests
+    runTest("Multiply (10^n - 1)^2", []() {
+        BigInteger nines(std::string(6000, '9'));
+        std::string expected = std::string(5999, '9') + "8" + std::string(5999, '0') + "1";
+        return toString(nines * nines) == expected ? "ok" : "mismatch";
+        }, "ok");
+    runTest("Multiplication kernels agree", []() {
+        LimbVector x, y;
+        XorShift next;
+        for (int i = 0; i < 700; ++i) {
+            uint64_t limb = next();
+            x.push_back(limb);
+            if (i < 400) y.push_back(~limb);
+        }
+        LimbVector expected = naive_mul(x, y);
+        if (karatsuba_mul(x, y) != expected) return "karatsuba";
+        if (toom3_mul(x, y) != expected) return "toom3";
+        if (ntt_mul(x, y) != expected) return "ntt";
+        // 700 + 325 - 1 coefficients fill a power-of-two transform, 700 + 400 - 1 a 3 * 2^k one
+        LimbVector z(x.begin(), x.begin() + 325);
+        if (ntt_mul(x, z) != naive_mul(x, z)) return "ntt power of two";
+        if (ntt_mul(y, y) != naive_mul(y, y)) return "ntt square";
+        if (multiply(x, y) != expected) return "multiply";
+        return "ok";
+        }, "ok");
+    runTest("Squaring kernels agree", []() {
+        LimbVector x;
+        XorShift next;
+        for (int i = 0; i < 1200; ++i) x.push_back(next());
+        for (size_t n : { 1, 2, 3, 95, 96, 150, 299, 300, 1200 }) {
+            LimbVector part(x.begin(), x.begin() + n);
+            LimbVector expected = naive_mul(part, LimbVector(part));
+            if (naive_sqr(part) != expected) return "naive_sqr";
+            if (karatsuba_sqr(part) != expected) return "karatsuba_sqr";
+            if (square(part) != expected) return "square";
+        }
+        LimbVector ones(40, ~0ULL);
+        if (naive_sqr(ones) != naive_mul(ones, LimbVector(ones))) return "carries";
+        return "ok";
+        }, "ok");
+    runTest("Two limb division does not allocate", []() {
+        BigInteger a("123456789012345678901234567890"), b("-98765432109876543210"), q;
+        return limbAllocationsDuring([&]() { q = a / b; });
+        }, "0");
+    runTest("Two limb remainder does not allocate", []() {
+        BigInteger a("123456789012345678901234567890"), b("-98765432109876543210"), r;
+        return limbAllocationsDuring([&]() { r = a % b; });
+        }, "0");
+    runTest("Division identity on limbs", []() {
+        XorShift random;
+        auto next = [&random]() {
+            uint64_t limb = random();
+            // saturated limbs push the quotient estimate into its correction steps
+            return limb % 4 == 0 ? ~0ULL : limb;
+        };
+        for (size_t n = 2; n < 40; n += 3) {
+            LimbVector a, b, q, r;
+            for (size_t i = 0; i < 2 * n + 1; ++i) a.push_back(next());
+            for (size_t i = 0; i < n; ++i) b.push_back(next());
+            divideMagnitude(a, b, q, r);
+            if (compareMagnitude(r, b) >= 0) return "remainder";
+            LimbVector back = multiply(q, b);
+            addInPlace(back, r);
+            if (back != a) return "identity";
+        }
+        return "ok";
+        }, "ok");
+    runTest("Subquadratic division identity", []() {
+        XorShift next;
+        // Burnikel-Ziegler for 400 / 200 limbs, Newton reciprocal for 5000 / 1100 limbs
+        for (size_t n : { 200, 1100 }) {
+            LimbVector a, b, q, r;
+            for (size_t i = 0; i < (n < 1000 ? 2 * n : 5000); ++i) a.push_back(next());
+            for (size_t i = 0; i < n; ++i) b.push_back(next());
+            divideMagnitude(a, b, q, r);
+            if (compareMagnitude(r, b) >= 0) return "remainder";
+            LimbVector back = multiply(q, b);
+            addInPlace(back, r);
+            if (back != a) return "identity";
+        }
+        return "ok";
+        }, "ok");
+    assert(BigInteger("340282366920938463463374607431768211455") / BigInteger("18446744073709551617") == BigInteger("18446744073709551615"));
+    assert(BigInteger("340282366920938463463374607431768211456") / BigInteger("-18446744073709551615") == BigInteger("-18446744073709551617"));
+    assert(BigInteger(-12345).square() == BigInteger(152399025));
+    assert(BigInteger(0).square() == BigInteger(0));
+    assert(BigInteger("-18446744073709551616").square() == BigInteger("340282366920938463463374607431768211456"));
+    {
+        BigInteger x("-123456789012345678901234567890");
+        BigInteger y = x;
+        y *= y;
+        assert(y == x * x);
+        assert(y == x.square());
+        assert(y == BigInteger("15241578753238836750495351562536198787501905199875019052100"));
+    }
     assert(BigInteger("00012") == BigInteger("+00012"));
     assert(BigInteger("00012") == -BigInteger("-00012"));
     assert(BigInteger("+00012") == -BigInteger("-00012"));
@@ -1344,6 +2125,27 @@ int main() {
     assert(toString(-BigRational(1, -2)) == "1/2");
     assert(toString(-BigRational(1, std::numeric_limits<int64_t>::min())) == "1/9223372036854775808");
 
+    //limb boundaries
+    assert(toString(BigInteger("18446744073709551615") + BigInteger(1)) == "18446744073709551616");
+    assert(toString(BigInteger("18446744073709551616") - BigInteger(1)) == "18446744073709551615");
+    assert(toString(BigInteger("-18446744073709551616") * BigInteger("18446744073709551616")) ==
+        "-340282366920938463463374607431768211456");
+    assert(BigInteger("340282366920938463463374607431768211457") / BigInteger("18446744073709551616") ==
+        BigInteger("18446744073709551616"));
+    assert(toString(BigInteger("10000000000000000000000000000000000000")) == "10000000000000000000000000000000000000");
+
+    //move and self assignment operators
+    BigInteger mv("123456789012345678901234567890");
+    BigInteger moved = std::move(mv);
+    assert(toString(moved) == "123456789012345678901234567890");
+    moved += moved;
+    assert(toString(moved) == "246913578024691357802469135780");
+    moved *= moved;
+    assert(toString(moved) == "60966315012955347001981406250144795150007620799500076208400");
+    assert(toString(BigInteger(7) - BigInteger("-18446744073709551616")) == "18446744073709551623");
+    moved -= moved;
+    assert(moved == BigInteger(0));
+
 
     return 0;
 }